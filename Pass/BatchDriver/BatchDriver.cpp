@@ -0,0 +1,410 @@
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/ModuleSlotTracker.h"
+#include "llvm/IR/TypeFinder.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/LegacyPassNameParser.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/PassRegistry.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/PluginLoader.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_ostream.h"
+#include <memory>
+#include <set>
+#include <string>
+
+using namespace llvm;
+using namespace std;
+
+/* Runs the legacy passes of the plugins given with -load over a bitcode (or
+   textual IR) file, like opt -enable-new-pm=0, but reads bitcode through a
+   memory-mapped buffer and only deserialises the bodies of the functions
+   that are analysed:
+
+     BatchDriver -load libReachingDefinition.so -ReachingDefinition in.bc */
+
+static cl::list<const PassInfo*, bool, PassNameParser> PassList(cl::desc("Passes to run:"));
+
+static cl::opt<std::string> InputFilename(cl::Positional, cl::init("-"),
+    cl::desc("<input bitcode or IR file>"));
+
+static cl::opt<std::string> OutputFilename("o", cl::init(""), cl::value_desc("filename"),
+    cl::desc("Write the module to this file (default: no output)"));
+
+static cl::opt<bool> OutputAssembly("S", cl::init(false),
+    cl::desc("Write the module as text instead of bitcode"));
+
+static cl::list<std::string> OnlyFunctions("func", cl::CommaSeparated, cl::value_desc("name,..."),
+    cl::desc("Run function passes on these functions only, the others are never loaded"));
+
+static cl::opt<bool> Stream("stream", cl::init(false),
+    cl::desc("Free each function body once its passes ran, writing it to -o as text first"));
+
+namespace
+{
+
+/* passes that need the whole module force every body to be loaded */
+bool needs_whole_module(std::vector<Pass*>& passes)
+{
+  for (Pass* P : passes){
+    if (P->getPassKind() != PT_Function){
+      return true;
+    }
+  }
+  return !OutputFilename.empty() && !Stream;
+}
+
+bool selected(Function& F, std::set<std::string>& only)
+{
+  return only.empty() || only.count(F.getName().str()) != 0;
+}
+
+/* Text of a module written while its function bodies come and go, which
+   reads back as the module Module::print would have written:
+     header  - identification, target, module asm, the named types known
+               up front, globals and aliases
+     bodies  - every function in module order, declarations included, each
+               printed right after its passes ran
+     trailer - named types first seen in a body, attribute groups and
+               metadata, which the bodies may add to
+   One slot tracker numbers everything printed, so a #N or !N in a body
+   names the group or node the trailer defines under that number. The
+   attribute groups are listed in the order the tracker numbers them: the
+   attributes of globals and functions, then those of call sites as each
+   body is printed. */
+class StreamWriter
+{
+public:
+  StreamWriter(Module& M, raw_ostream& os) : M(M), os(os), slots(&M, false)
+  {
+    for (auto &G : M.globals()){
+      add_attributes(G.getAttributes());
+    }
+    for (auto &F : M){
+      add_attributes(F.getAttributes().getFnAttrs());
+    }
+  }
+
+  void header()
+  {
+    os << "; ModuleID = '" << M.getModuleIdentifier() << "'\n";
+    os << "source_filename = \"";
+    printEscapedString(M.getSourceFileName(), os);
+    os << "\"\n";
+    if (!M.getDataLayoutStr().empty()){
+      os << "target datalayout = \"" << M.getDataLayoutStr() << "\"\n";
+    }
+    if (!M.getTargetTriple().empty()){
+      os << "target triple = \"" << M.getTargetTriple() << "\"\n";
+    }
+    SmallVector<StringRef, 4> asm_lines;
+    StringRef(M.getModuleInlineAsm()).split(asm_lines, '\n', -1, false);
+    for (StringRef line : asm_lines){
+      os << "module asm \"";
+      printEscapedString(line, os);
+      os << "\"\n";
+    }
+
+    TypeFinder types;
+    types.run(M, true);
+    for (StructType* type : types){
+      add_type(type);
+    }
+    print_types();
+
+    if (!M.global_empty()){
+      os << "\n";
+    }
+    for (auto &G : M.globals()){
+      G.print(os, slots);
+      os << "\n";
+    }
+    if (!M.alias_empty()){
+      os << "\n";
+    }
+    for (auto &A : M.aliases()){
+      A.print(os, slots);
+      os << "\n";
+    }
+    if (!M.ifunc_empty()){
+      os << "\n";
+    }
+    for (auto &I : M.ifuncs()){
+      I.print(os, slots);
+      os << "\n";
+    }
+  }
+
+  void function(Function& F)
+  {
+    for (auto &basic_block : F){
+      for (auto &inst : basic_block){
+        add_type(inst.getType());
+        for (auto &op : inst.operands()){
+          add_type(op->getType());
+        }
+        if (AllocaInst* alloca_inst = dyn_cast<AllocaInst>(&inst)){
+          add_type(alloca_inst->getAllocatedType());
+        }else if (GetElementPtrInst* gep = dyn_cast<GetElementPtrInst>(&inst)){
+          add_type(gep->getSourceElementType());
+        }else if (CallBase* call = dyn_cast<CallBase>(&inst)){
+          add_type(call->getFunctionType());
+          add_attributes(call->getAttributes().getFnAttrs());
+        }
+      }
+    }
+    /* a declaration is printed with its own leading newline */
+    if (!F.isDeclaration()){
+      os << "\n";
+    }
+    static_cast<Value&>(F).print(os, slots);
+  }
+
+  void trailer()
+  {
+    print_types();
+
+    if (!attribute_groups.empty()){
+      os << "\n";
+    }
+    for (unsigned i = 0; i < attribute_groups.size(); i++){
+      os << "attributes #" << i << " = { " << attribute_groups[ i ].getAsString(true) << " }\n";
+    }
+
+    if (!M.named_metadata_empty()){
+      os << "\n";
+    }
+    for (auto &named : M.named_metadata()){
+      named.print(os, slots);
+    }
+    ModuleSlotTracker::MachineMDNodeListType nodes;
+    slots.collectMDNodes(nodes, 0, ~0U);
+    llvm::sort(nodes, [](const std::pair<unsigned, const MDNode*>& a, const std::pair<unsigned, const MDNode*>& b){
+      return a.first < b.first;
+    });
+    if (!nodes.empty()){
+      os << "\n";
+    }
+    for (auto &node : nodes){
+      node.second->print(os, slots, &M);
+      os << "\n";
+    }
+  }
+
+private:
+  Module& M;
+  raw_ostream& os;
+  ModuleSlotTracker slots;
+  SetVector<AttributeSet> attribute_groups;
+  SmallPtrSet<Type*, 32> seen_types;
+  std::vector<StructType*> named_types;
+  unsigned printed_types = 0;
+
+  void add_attributes(AttributeSet attributes)
+  {
+    if (attributes.hasAttributes()){
+      attribute_groups.insert(attributes);
+    }
+  }
+
+  void add_type(Type* type)
+  {
+    if (!seen_types.insert(type).second){
+      return;
+    }
+    StructType* struct_type = dyn_cast<StructType>(type);
+    if (struct_type && !struct_type->isLiteral()){
+      named_types.push_back(struct_type);
+    }
+    for (Type* sub : type->subtypes()){
+      add_type(sub);
+    }
+  }
+
+  /* named types added since the last call */
+  void print_types()
+  {
+    if (printed_types < named_types.size()){
+      os << "\n";
+    }
+    for (; printed_types < named_types.size(); printed_types++){
+      named_types[ printed_types ]->print(os);
+      os << "\n";
+    }
+  }
+};
+
+/* function passes one function at a time; a body is materialised from the
+   bitcode only when its function is run. When streaming, the body is
+   written (if there is an output) and deleted right after, so at most one
+   function is in memory */
+bool run_lazily(Module& M, std::vector<Pass*>& passes, StreamWriter* writer)
+{
+  std::set<std::string> only(OnlyFunctions.begin(), OnlyFunctions.end());
+  legacy::FunctionPassManager FPM(&M);
+  for (Pass* P : passes){
+    FPM.add(P);
+  }
+
+  FPM.doInitialization();
+  for (auto &F : M){
+    bool run = !F.isDeclaration() && selected(F, only);
+    /* the output has every function, run or not */
+    if (!run && !(Stream && writer)){
+      continue;
+    }
+    if (Error E = F.materialize()){
+      errs() << "BatchDriver: " << toString(std::move(E)) << "\n";
+      return false;
+    }
+    if (run){
+      FPM.run(F);
+    }
+    if (Stream){
+      if (writer){
+        writer->function(F);
+      }
+      F.deleteBody();
+    }
+  }
+  FPM.doFinalization();
+  return true;
+}
+
+bool run_on_module(Module& M, std::vector<Pass*>& passes)
+{
+  if (Error E = M.materializeAll()){
+    errs() << "BatchDriver: " << toString(std::move(E)) << "\n";
+    return false;
+  }
+  legacy::PassManager PM;
+  for (Pass* P : passes){
+    PM.add(P);
+  }
+  PM.run(M);
+  return true;
+}
+
+bool write_module(Module& M)
+{
+  std::error_code EC;
+  ToolOutputFile out(OutputFilename, EC, OutputAssembly ? sys::fs::OF_Text : sys::fs::OF_None);
+  if (EC){
+    errs() << "BatchDriver: " << OutputFilename << ": " << EC.message() << "\n";
+    return false;
+  }
+  if (OutputAssembly){
+    M.print(out.os(), nullptr);
+  }else{
+    WriteBitcodeToFile(M, out.os());
+  }
+  out.keep();
+  return true;
+}
+
+/* Streaming run: the functions are written as they are finished, between
+   the header and trailer of a StreamWriter, so the output reads back as
+   the module -o writes without -stream. Module passes see every function
+   at once and cannot stream. */
+bool stream_functions(Module& M, std::vector<Pass*>& passes)
+{
+  if (needs_whole_module(passes)){
+    errs() << "BatchDriver: -stream runs function passes only\n";
+    return false;
+  }
+
+  std::unique_ptr<ToolOutputFile> out;
+  std::unique_ptr<StreamWriter> writer;
+  if (!OutputFilename.empty()){
+    std::error_code EC;
+    out = std::make_unique<ToolOutputFile>(OutputFilename, EC, sys::fs::OF_Text);
+    if (EC){
+      errs() << "BatchDriver: " << OutputFilename << ": " << EC.message() << "\n";
+      return false;
+    }
+    writer = std::make_unique<StreamWriter>(M, out->os());
+    writer->header();
+  }
+
+  if (!run_lazily(M, passes, writer.get())){
+    return false;
+  }
+  if (out){
+    writer->trailer();
+    out->keep();
+  }
+  return true;
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char** argv)
+{
+  InitLLVM X(argc, argv);
+
+  /* analyses the plugin passes ask for (dominators, loops, frequencies) */
+  PassRegistry& registry = *PassRegistry::getPassRegistry();
+  initializeCore(registry);
+  initializeAnalysis(registry);
+  initializeTransformUtils(registry);
+  initializeScalarOpts(registry);
+
+  cl::ParseCommandLineOptions(argc, argv, "batch driver for the pass plugins\n");
+
+  /* large files are mapped rather than read; the null terminator is only
+     needed by the text parser, which gets a copy */
+  ErrorOr<std::unique_ptr<MemoryBuffer>> buffer =
+      MemoryBuffer::getFileOrSTDIN(InputFilename, false, false);
+  if (!buffer){
+    errs() << "BatchDriver: " << InputFilename << ": " << buffer.getError().message() << "\n";
+    return 1;
+  }
+  if (!isBitcode((const unsigned char*)(*buffer)->getBufferStart(),
+                 (const unsigned char*)(*buffer)->getBufferEnd())){
+    *buffer = MemoryBuffer::getMemBufferCopy((*buffer)->getBuffer(), (*buffer)->getBufferIdentifier());
+  }
+
+  LLVMContext context;
+  SMDiagnostic diagnostic;
+  std::unique_ptr<Module> M = getLazyIRModule(std::move(*buffer), diagnostic, context, true);
+  if (!M){
+    diagnostic.print(argv[ 0 ], errs());
+    return 1;
+  }
+
+  std::vector<Pass*> passes;
+  for (const PassInfo* info : PassList){
+    if (info->getNormalCtor() == nullptr){
+      errs() << "BatchDriver: cannot create pass " << info->getPassName() << "\n";
+      return 1;
+    }
+    passes.push_back(info->getNormalCtor()());
+  }
+
+  if (Stream){
+    return stream_functions(*M, passes) ? 0 : 1;
+  }
+
+  bool ok = true;
+  if (!passes.empty()){
+    ok = needs_whole_module(passes) ? run_on_module(*M, passes) : run_lazily(*M, passes, nullptr);
+  }
+  if (ok && !OutputFilename.empty()){
+    ok = write_module(*M);
+  }
+  return ok ? 0 : 1;
+}
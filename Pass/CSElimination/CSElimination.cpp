@@ -7,29 +7,102 @@
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/CFG.h"
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/Local.h"
 #include <string>
 #include <fstream>
 #include <unordered_map>
+#include <map>
 #include <set>
 #include <queue>
+#include <vector>
+#include <algorithm>
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include "Common/InstructionNumbering.h"
+#include "ReachingDefinition/ReachingDefinition.h"
+#include "EdgeProfile/EdgeProfile.h"
 
 using namespace llvm;
 using namespace std;
 
 #define DEBUG_TYPE "CSElimination"
 
+static cl::opt<bool> CopyPropagation("cse-copy-prop", cl::init(false),
+    cl::desc("Forward copies between locals before eliminating subexpressions"));
+static cl::opt<bool> PartialRedundancy("cse-pre", cl::init(false),
+    cl::desc("Eliminate partially redundant expressions with lazy code motion"));
+static cl::opt<std::string> ProfileFile("cse-profile", cl::init(""),
+    cl::desc("Edge profile written by the EdgeProfile runtime, used to rank blocks by hotness"));
+static cl::opt<double> HotThreshold("cse-hot-threshold", cl::init(0.0),
+    cl::desc("Only eliminate in blocks executed at least this many times per call of the function"));
+static cl::opt<int> WorkBudget("cse-budget", cl::init(0),
+    cl::desc("Candidate computations considered per function, hottest blocks first (0 = no limit)"));
+static cl::opt<unsigned> MaxBlocks("cse-max-blocks", cl::init(0),
+    cl::desc("Only do local CSE in functions with more blocks than this (0 = no limit)"));
+static cl::opt<unsigned> MaxInstructions("cse-max-instructions", cl::init(0),
+    cl::desc("Only do local CSE in functions with more instructions than this (0 = no limit)"));
+static cl::opt<unsigned> MaxIterations("cse-max-iterations", cl::init(0),
+    cl::desc("Give up a global stage whose dataflow needs more sweeps than this (0 = no limit)"));
+static cl::opt<double> MaxTime("cse-max-time", cl::init(0),
+    cl::desc("Give up the global stages after this many seconds per function (0 = no limit)"));
+static cl::opt<bool> Canonicalize("cse-canonical", cl::init(false),
+    cl::desc("Match expressions in a normal form (operand order, x - C as x + -C, x << C as x * 2^C, constant chains)"));
+static cl::opt<bool> MatchLoads("cse-match-loads", cl::init(false),
+    cl::desc("Match loads of a local by the definitions that reach them, not by the load instruction"));
+static cl::opt<bool> FoldCompares("cse-compares", cl::init(false),
+    cl::desc("Number comparisons and fold those implied by a dominating branch condition"));
+static cl::opt<bool> MatchAddresses("cse-addresses", cl::init(false),
+    cl::desc("Number getelementptr and cast instructions like binary operators"));
+static cl::opt<bool> PureCalls("cse-pure-calls", cl::init(false),
+    cl::desc("Number calls to readnone and readonly functions by callee and arguments"));
+static cl::opt<bool> VerifyOutput("cse-verify", cl::init(false),
+    cl::desc("Run the IR verifier on every function after it was rewritten, abort if it fails"));
+
+STATISTIC(NumStatementsReplaced, "Statements replaced by a temporary in the default scheme");
+STATISTIC(NumLocalOnly, "Functions too large for global CSE, local CSE only");
+STATISTIC(NumCopyPropSkipped, "Functions where copy propagation ran out of budget");
+STATISTIC(NumPRESkipped, "Functions where lazy code motion ran out of budget");
+STATISTIC(NumEliminationStopped, "Functions where global elimination ran out of time");
+STATISTIC(NumLoadsMatched, "Loads that stand for an earlier load of the same value");
+STATISTIC(NumComparesFolded, "Comparisons folded to a constant by a dominating branch condition");
+STATISTIC(NumBranchesFolded, "Conditional branches made unconditional");
+STATISTIC(NumVerified, "Functions checked by the IR verifier after elimination");
 
 
 namespace
 {
 
-std::map<llvm::BasicBlock*,map<int, llvm::Instruction*>> global_inst_map;
-std::map<llvm::BasicBlock*,map<int, llvm::Instruction*>> global_inst_op_map;
-std::map<llvm::BasicBlock*,map<int, llvm::Instruction*>> global_inst_stor_map;
-std::map<llvm::BasicBlock*,map<int, llvm::Instruction*>> global_inst_load_map;
+/* per function: index of every instruction, and per block the indexes
+   (increasing) of its operations, stores and loads */
+struct BlockInstructions
+{
+  SmallVector<int, 8> ops;
+  SmallVector<int, 4> stores;
+  SmallVector<int, 4> loads;
+};
+InstructionNumbering global_numbering;
+DenseMap<llvm::BasicBlock*, BlockInstructions> global_block_map;
 std::map<llvm::Value*, std::string> valueToStringMap;
 
+/* operation with this index in bb, nullptr if bb has none */
+llvm::Instruction* op_in_block(llvm::BasicBlock* bb, int index)
+{
+  SmallVector<int, 8>& ops = global_block_map[ bb ].ops;
+  if (std::binary_search(ops.begin(), ops.end(), index)){
+    return global_numbering[ index ];
+  }
+  return nullptr;
+}
+
 std::vector<llvm::BasicBlock*> get_pred_blocks(llvm::BasicBlock *block) {
     std::vector<llvm::BasicBlock*> predecessors;
 
@@ -48,8 +121,7 @@ std::vector<llvm::BasicBlock*> get_pred_blocks(llvm::BasicBlock *block) {
 bool available_at_entry(llvm::BasicBlock* bb, int index){
 
   /* get the instructions and operands */
-  std::map<int, llvm::Instruction*> temp1 = global_inst_op_map[ bb ];
-  llvm::Instruction* temp_inst = temp1[ index ];
+  llvm::Instruction* temp_inst = op_in_block(bb, index);
   
 
   bool toggle = true;
@@ -70,14 +142,11 @@ bool available_at_entry(llvm::BasicBlock* bb, int index){
       /* for each prev block check if there is the same computation say B op C*/
       for ( int i = 0 ; i < prevblocks.size(); i++){
 
-        std::map<int, llvm::Instruction*> temp2 = global_inst_op_map[ prevblocks[i] ];
         bool match_found_in_this_block = false;
 
         /* each operation instruction */
-        for ( const auto &pair : temp2 ){
-          int key = pair.first;
-
-          llvm::Instruction* prev_temp_inst = pair.second;
+        for ( int key : global_block_map[ prevblocks[i] ].ops ){
+          llvm::Instruction* prev_temp_inst = global_numbering[ key ];
 
           if (prev_temp_inst->isSameOperationAs(temp_inst)){
             llvm::Value* prev_op1 = prev_temp_inst->getOperand(0);
@@ -102,8 +171,7 @@ bool available_at_entry(llvm::BasicBlock* bb, int index){
 
 bool not_redefined_bef_S(llvm::BasicBlock* bb, int index){
   /* get the instructions and operands */
-  std::map<int, llvm::Instruction*> temp1 = global_inst_op_map[ bb ];
-  llvm::Instruction* temp_inst = temp1[ index ];
+  llvm::Instruction* temp_inst = op_in_block(bb, index);
   if (llvm::isa<llvm::BinaryOperator>(temp_inst)){
     /* check if any of the operand is redefined before our instruction */
     auto operand1 = dyn_cast<User>(temp_inst)->getOperand(0); 
@@ -112,12 +180,9 @@ bool not_redefined_bef_S(llvm::BasicBlock* bb, int index){
     
     /* check if any of the operands are redefined bfore S */
     /* get all store instructions in our basic block */
-    std::map<int, llvm::Instruction*> temp2 = global_inst_stor_map[ bb ];
-
-    for ( auto &pair : temp2 ){
-      int key = pair.first;
+    for ( int key : global_block_map[ bb ].stores ){
       if (key < index){
-        llvm::Instruction* temp_inst_load = pair.second;
+        llvm::Instruction* temp_inst_load = global_numbering[ key ];
         StoreInst *store_instruction = dyn_cast<StoreInst>(temp_inst_load); 
         llvm::Value* definition = store_instruction->getPointerOperand();
 
@@ -137,8 +202,7 @@ bool not_redefined_bef_S(llvm::BasicBlock* bb, int index){
 std::vector<int> defs_that_reach_s(llvm::BasicBlock* bb, int index){
 
   vector<int> result;
-  std::map<int, llvm::Instruction*> temp1 = global_inst_op_map[ bb ];
-  llvm::Instruction* temp_inst = temp1[ index ];
+  llvm::Instruction* temp_inst = op_in_block(bb, index);
 
   if (llvm::isa<llvm::BinaryOperator>(temp_inst)){
     /* check if any of the operand is redefined before our instruction */
@@ -149,11 +213,8 @@ std::vector<int> defs_that_reach_s(llvm::BasicBlock* bb, int index){
     std::vector<llvm::BasicBlock*> prevblocks = get_pred_blocks(bb);
     if (prevblocks.size() != 0 ){
       for ( int i = 0 ; i < prevblocks.size(); i++){
-        std::map<int, llvm::Instruction*> temp2 = global_inst_op_map[ prevblocks[i] ];
-        for ( const auto &pair : temp2 ){
-          int key = pair.first;
-
-          llvm::Instruction* prev_temp_inst = pair.second;
+        for ( int key : global_block_map[ prevblocks[i] ].ops ){
+          llvm::Instruction* prev_temp_inst = global_numbering[ key ];
 
           if (prev_temp_inst->isSameOperationAs(temp_inst)){
             llvm::Value*  prev_op1 = prev_temp_inst->getOperand(0);
@@ -171,36 +232,54 @@ std::vector<int> defs_that_reach_s(llvm::BasicBlock* bb, int index){
   return result;
 }
 
-void replace_each_statement(std::vector<int>& def, std::string& t, llvm::BasicBlock* bb) {
-    for (int index : def) {
-        llvm::Instruction* inst = global_inst_op_map[bb][index];
-        // Create a new temporary variable
-        IRBuilder<> Builder(bb);
-        AllocaInst* tempVar = Builder.CreateAlloca(inst->getType(), nullptr, t);
+/* S (the operation with this index in bb) is available from every
+   predecessor: each definition D = B op C that reaches S saves its value in
+   a new temporary t, and S reads t instead. The definitions are in the
+   predecessors, so they are looked up through the numbering. Returns false
+   if S was left as it is. */
+bool replace_each_statement(std::vector<int>& def, std::string& t, llvm::BasicBlock* bb, int index) {
+    llvm::Instruction* statement = op_in_block(bb, index);
+    if (def.empty()) {
+        return false;
+    }
+    for (int d : def) {
+        llvm::Instruction* inst = global_numbering[ d ];
+        /* nsw/nuw/exact must agree, or S could become poison; a definition
+           in bb itself comes from the previous trip around a loop */
+        if (inst->getParent() == bb ||
+            inst->getRawSubclassOptionalData() != statement->getRawSubclassOptionalData()) {
+            return false;
+        }
+    }
 
-        /* Replace the instruction with a store to the temporary variable */
-        StoreInst* storeInst = new StoreInst(inst, tempVar, false, inst);
-        ReplaceInstWithInst(inst, storeInst);
+    // Create a new temporary variable at the start of the function
+    llvm::BasicBlock& entry = bb->getParent()->getEntryBlock();
+    AllocaInst* tempVar = new AllocaInst(statement->getType(),
+                                         bb->getModule()->getDataLayout().getAllocaAddrSpace(),
+                                         StringRef(t), &*entry.getFirstInsertionPt());
 
-        // Replace all uses of the original instruction with the temporary variable
-        for (auto& U : inst->uses()) {
-            User* user = U.getUser();
-            user->setOperand(U.getOperandNo(), tempVar);
-        }
+    /* each definition D = B op C also stores into the temporary */
+    for (int d : def) {
+        llvm::Instruction* inst = global_numbering[ d ];
+        new StoreInst(inst, tempVar, inst->getNextNode());
     }
-} 
 
-void printGlobalMap(const std::map<llvm::BasicBlock*, std::map<int, llvm::Instruction*>>& globalMap) {
-    for (const auto& blockMapPair : globalMap) {
-        const llvm::BasicBlock* block = blockMapPair.first;
-        const std::map<int, llvm::Instruction*>& instMap = blockMapPair.second;
+    /* and S reads it; S leaves the op list so no later S' takes it as a definition */
+    LoadInst* reload = new LoadInst(statement->getType(), tempVar, "", statement);
+    statement->replaceAllUsesWith(reload);
+    SmallVector<int, 8>& ops = global_block_map[ bb ].ops;
+    ops.erase(std::lower_bound(ops.begin(), ops.end(), index));
+    statement->eraseFromParent();
+    return true;
+}
 
-        std::string blockName = (block->hasName()) ? block->getName().str() : "unnamed";
+void printGlobalMap(Function& F) {
+    for (auto& block : F) {
+        std::string blockName = (block.hasName()) ? block.getName().str() : "unnamed";
         llvm::errs() << "Basic Block: " << blockName << "\n";
 
-        for (const auto& instPair : instMap) {
-            int index = instPair.first;
-            llvm::Instruction* inst = instPair.second;
+        for (unsigned index = global_numbering.block_begin(&block); index < global_numbering.block_end(&block); index++) {
+            llvm::Instruction* inst = global_numbering[index];
 
             std::string instStr;
             llvm::raw_string_ostream rso(instStr);
@@ -214,69 +293,1290 @@ void printGlobalMap(const std::map<llvm::BasicBlock*, std::map<int, llvm::Instru
 
 
 
+/* S: store (load x), z  is a copy of x into z */
+bool is_copy(llvm::Instruction* inst)
+{
+  StoreInst* store_instruction = dyn_cast<StoreInst>(inst);
+  if (store_instruction == nullptr || store_instruction->isVolatile()){
+    return false;
+  }
+  LoadInst* source = dyn_cast<LoadInst>(store_instruction->getValueOperand());
+  return source && !source->isVolatile() &&
+         is_tracked_var(source->getPointerOperand()) &&
+         is_tracked_var(store_instruction->getPointerOperand()) &&
+         source->getPointerOperand() != store_instruction->getPointerOperand();
+}
+
+/* Forward the source of copies z = x to later loads of z whose only reaching
+   definition is the copy. Only a copy that dominates the load is forwarded,
+   its stored value is then reused directly. A copy that does not dominate
+   the load would need a fresh load of x, and equal reaching definitions of
+   x at both points do not rule out a store to x in between (a copy in the
+   first iteration of a loop that writes x afterwards).
+   Returns the number of loads forwarded; nothing is forwarded if the
+   reaching definitions ran out of budget, gave_up then names the limit. */
+int propagate_copies(Function &F, DominatorTree &DT, const AnalysisBudget& budget, std::string& gave_up)
+{
+  ReachingDefinitionInfo info;
+  compute_reaching_definitions(F, info, budget);
+  if (!info.exceeded.empty()){
+    gave_up = info.exceeded;
+    return 0;
+  }
+
+  std::vector<std::pair<llvm::LoadInst*, llvm::Value*>> forwards;
+  for (auto &basic_block : F){
+    for (auto &inst : basic_block){
+      LoadInst* load_instruction = dyn_cast<LoadInst>(&inst);
+      if (load_instruction == nullptr || load_instruction->isVolatile() ||
+          !is_tracked_var(load_instruction->getPointerOperand())){
+        continue;
+      }
+
+      SmallVector<int, 4> defs = defs_reaching_load(load_instruction, info);
+      if (defs.size() != 1 || !is_copy(info.numbering[ defs[0] ])){
+        continue;
+      }
+      StoreInst* copy = cast<StoreInst>(info.numbering[ defs[0] ]);
+      LoadInst* source = cast<LoadInst>(copy->getValueOperand());
+      if (source->getType() != load_instruction->getType()){
+        continue;
+      }
+
+      if (DT.dominates(copy, load_instruction)){
+        forwards.push_back(std::make_pair(load_instruction, source));
+      }
+    }
+  }
+
+  /* a forwarded value may itself be a load that gets forwarded */
+  DenseMap<llvm::Value*, llvm::Value*> replaced;
+  for (auto &pair : forwards){
+    llvm::Value* value = pair.second;
+    while (replaced.find(value) != replaced.end()){
+      value = replaced[ value ];
+    }
+    pair.first->replaceAllUsesWith(value);
+    replaced[ pair.first ] = value;
+  }
+  for (auto &pair : forwards){
+    pair.first->eraseFromParent();
+  }
+
+  return forwards.size();
+}
+
+/* stores to locals that are never loaded any more are dead, remove them
+   together with the allocation. Returns the number of stores removed. */
+int remove_dead_stores(Function &F)
+{
+  int removed = 0;
+  std::vector<llvm::AllocaInst*> dead_vars;
+  for (auto &inst : F.getEntryBlock()){
+    AllocaInst* alloca_inst = dyn_cast<AllocaInst>(&inst);
+    if (alloca_inst == nullptr || !is_tracked_var(alloca_inst)){
+      continue;
+    }
+    bool only_stored = true;
+    for (auto *user : alloca_inst->users()){
+      if (!isa<StoreInst>(user)){
+        only_stored = false;
+      }
+    }
+    if (only_stored){
+      dead_vars.push_back(alloca_inst);
+    }
+  }
+
+  for (auto *alloca_inst : dead_vars){
+    while (!alloca_inst->use_empty()){
+      StoreInst* store_instruction = cast<StoreInst>(alloca_inst->user_back());
+      llvm::Value* value = store_instruction->getValueOperand();
+      store_instruction->eraseFromParent();
+      RecursivelyDeleteTriviallyDeadInstructions(value);
+      removed++;
+    }
+    alloca_inst->eraseFromParent();
+  }
+  return removed;
+}
+
+/* ---------------- Partial redundancy elimination (lazy code motion) ---------------- */
+
+/* An expression is identified by its operator and operands, two
+   instructions with the same Expression compute the same value as long as
+   no operand is redefined in between. predicate is 0 except for compares,
+   indexed_type nullptr except for getelementptr. reads_memory is set for
+   readonly calls, their value also depends on memory; it follows from the
+   callee and is not part of the key. */
+struct Expression
+{
+  unsigned opcode;
+  unsigned flags;
+  unsigned predicate = 0;
+  llvm::Type* type;
+  llvm::Type* indexed_type = nullptr;
+  SmallVector<llvm::Value*, 2> operands;
+  bool reads_memory = false;
+
+  bool operator==(const Expression& other) const
+  {
+    return opcode == other.opcode && flags == other.flags && predicate == other.predicate &&
+           type == other.type && indexed_type == other.indexed_type && operands == other.operands;
+  }
+};
+
+/* hashing of Expression keys in DenseMaps; no instruction has the opcodes
+   of the empty and tombstone keys */
+struct ExpressionInfo
+{
+  static Expression special(unsigned opcode)
+  {
+    Expression e;
+    e.opcode = opcode;
+    e.flags = 0;
+    e.type = nullptr;
+    return e;
+  }
+  static Expression getEmptyKey() { return special(~0U); }
+  static Expression getTombstoneKey() { return special(~0U - 1); }
+  static unsigned getHashValue(const Expression& e)
+  {
+    return hash_combine(e.opcode, e.flags, e.predicate, e.type, e.indexed_type,
+                        hash_combine_range(e.operands.begin(), e.operands.end()));
+  }
+  static bool isEqual(const Expression& a, const Expression& b) { return a == b; }
+};
+
+template <typename T>
+using ExpressionMap = DenseMap<Expression, T, ExpressionInfo>;
+
+/* -cse-match-loads: every load of a tracked local and the first load in
+   layout order that reads the same definitions of it. Loads not in the map
+   only match themselves. */
+DenseMap<llvm::Value*, llvm::Value*> load_leader;
+
+/* Are all uses of the load later in its block, with no store to its local
+   in between? Only then does the local still hold the loaded value wherever
+   it is used, which is what lets an expression over the load be killed by
+   stores to the local and be recomputed by loading it again. */
+bool used_before_store(llvm::LoadInst* load_instruction)
+{
+  SmallPtrSet<llvm::User*, 4> users(load_instruction->user_begin(), load_instruction->user_end());
+  llvm::Value* var = load_instruction->getPointerOperand();
+  for (auto it = std::next(load_instruction->getIterator()); it != load_instruction->getParent()->end(); ++it){
+    if (users.empty()){
+      break;
+    }
+    if (!llvm::isa<llvm::PHINode>(&*it)){
+      users.erase(&*it);
+    }
+    StoreInst* store_instruction = dyn_cast<StoreInst>(&*it);
+    if (store_instruction && store_instruction->getPointerOperand() == var){
+      break;
+    }
+  }
+  return users.empty();
+}
+
+/* Number the loads of F for -cse-match-loads. Two loads of a local with the
+   same set of reaching definitions read the same value as long as no store
+   to the local runs in between, which the kills below take care of. A load
+   that is still used after a store to its local is left out: it holds the
+   old value there, not the local's.
+   Returns the number of loads that were mapped to an earlier one; nothing
+   is mapped if the reaching definitions ran out of budget, gave_up then
+   names the limit. */
+int number_loads(Function &F, const AnalysisBudget& budget, std::string& gave_up)
+{
+  load_leader.clear();
+  ReachingDefinitionInfo info;
+  compute_reaching_definitions(F, info, budget);
+  if (!info.exceeded.empty()){
+    gave_up = info.exceeded;
+    return 0;
+  }
+
+  /* first loads, by local and hash of loaded type and reaching definitions */
+  int matched = 0;
+  DenseMap<std::pair<llvm::Value*, unsigned>, SmallVector<llvm::LoadInst*, 2>> first;
+  DenseMap<llvm::LoadInst*, SmallVector<int, 4>> first_defs;
+  for (auto &basic_block : F){
+    for (auto &inst : basic_block){
+      LoadInst* load_instruction = dyn_cast<LoadInst>(&inst);
+      if (load_instruction == nullptr || !load_instruction->isSimple() ||
+          !is_tracked_var(load_instruction->getPointerOperand()) || !used_before_store(load_instruction)){
+        continue;
+      }
+      SmallVector<int, 4> defs = defs_reaching_load(load_instruction, info);
+      unsigned hash = hash_combine(load_instruction->getType(), hash_combine_range(defs.begin(), defs.end()));
+      SmallVector<llvm::LoadInst*, 2>& candidates = first[ std::make_pair(load_instruction->getPointerOperand(), hash) ];
+
+      llvm::LoadInst* leader = nullptr;
+      for (auto *candidate : candidates){
+        if (candidate->getType() == load_instruction->getType() && first_defs[ candidate ] == defs){
+          leader = candidate;
+        }
+      }
+      if (leader == nullptr){
+        leader = load_instruction;
+        candidates.push_back(load_instruction);
+        first_defs[ load_instruction ] = defs;
+      }else{
+        matched++;
+      }
+      load_leader[ load_instruction ] = leader;
+    }
+  }
+  return matched;
+}
+
+/* load numbered by number_loads, nullptr for any other value */
+llvm::LoadInst* numbered_load(llvm::Value* value)
+{
+  LoadInst* load_instruction = dyn_cast<LoadInst>(value);
+  return load_instruction && load_leader.count(load_instruction) ? load_instruction : nullptr;
+}
+
+/* loads that became unused after their expressions were eliminated */
+void remove_unused_loads()
+{
+  for (auto &pair : load_leader){
+    LoadInst* load_instruction = cast<LoadInst>(pair.first);
+    if (load_instruction->use_empty()){
+      load_instruction->eraseFromParent();
+    }
+  }
+  load_leader.clear();
+}
+
+/* a call whose result only depends on its arguments (readnone) or on its
+   arguments and memory (readonly) */
+bool is_pure_call(llvm::Instruction* inst)
+{
+  CallInst* call = dyn_cast<CallInst>(inst);
+  return call && call->getCalledFunction() && !call->getType()->isVoidTy() &&
+         !call->isMustTailCall() && !call->hasOperandBundles() && !call->isConvergent() &&
+         call->onlyReadsMemory();
+}
+
+/* can inst change what a readonly call reads? Tracked locals never escape,
+   so no callee can see them */
+bool clobbers_memory(llvm::Instruction* inst)
+{
+  if (StoreInst* store_instruction = dyn_cast<StoreInst>(inst)){
+    return store_instruction->isVolatile() || !is_tracked_var(store_instruction->getPointerOperand());
+  }
+  return inst->mayWriteToMemory();
+}
+
+/* instructions that take part in expression matching */
+bool is_candidate(llvm::Instruction* inst)
+{
+  return llvm::isa<llvm::BinaryOperator>(inst) || (FoldCompares && llvm::isa<llvm::CmpInst>(inst)) ||
+         (MatchAddresses && (llvm::isa<llvm::GetElementPtrInst>(inst) || llvm::isa<llvm::CastInst>(inst))) ||
+         (PureCalls && is_pure_call(inst));
+}
+
+/* constants right of commutative operators, other operands in a fixed order */
+void order_operands(Expression& e)
+{
+  if (!Instruction::isCommutative(e.opcode)){
+    return;
+  }
+  bool constant0 = llvm::isa<llvm::Constant>(e.operands[0]);
+  bool constant1 = llvm::isa<llvm::Constant>(e.operands[1]);
+  if ((constant0 && !constant1) || (constant0 == constant1 && e.operands[1] < e.operands[0])){
+    std::swap(e.operands[0], e.operands[1]);
+  }
+}
+
+Expression make_expression(llvm::Instruction* inst);
+
+/* does inst use a load numbered by -cse-match-loads? */
+bool reads_numbered_load(llvm::Instruction* inst)
+{
+  for (auto &op : inst->operands()){
+    if (numbered_load(op.get())){
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Normal form of -cse-canonical, so one lookup finds every equivalent
+   computation:
+     x - C          ->  x + (-C)
+     x << C         ->  x * 2^C   for C < bits - 1 only: a shift by the bit
+                                  width or more is poison, not a product
+     a + (0 - b)    ->  a - b
+     (x op C1) op C2 -> x op (C1 op C2)   for add, mul, and, or, xor
+   A rewrite that would change when the result is poison (nsw/nuw) is not
+   done, so the nsw arithmetic of signed C code is only reordered. Nor does
+   a rewrite look through an instruction that uses a numbered load: the
+   load only stands for its local up to that instruction, and a store to
+   the local may come before the one being keyed. */
+void canonicalize(Expression& e)
+{
+  const unsigned NUW = OverflowingBinaryOperator::NoUnsignedWrap;
+  const unsigned NSW = OverflowingBinaryOperator::NoSignedWrap;
+
+  ConstantInt* c = dyn_cast<ConstantInt>(e.operands[1]);
+  if (e.opcode == Instruction::Sub && c && !(e.flags & NUW) &&
+      !((e.flags & NSW) && c->getValue().isMinSignedValue())){
+    e.opcode = Instruction::Add;
+    e.operands[1] = ConstantInt::get(c->getType(), -c->getValue());
+  }else if (e.opcode == Instruction::Shl && c && c->getValue().ult(c->getBitWidth() - 1)){
+    e.opcode = Instruction::Mul;
+    e.operands[1] = ConstantInt::get(c->getType(), APInt::getOneBitSet(c->getBitWidth(), c->getZExtValue()));
+  }
+
+  if (e.opcode == Instruction::Add && e.flags == 0){
+    for (int i = 0; i < 2; i++){
+      BinaryOperator* neg = dyn_cast<BinaryOperator>(e.operands[ i ]);
+      if (neg && neg->getOpcode() == Instruction::Sub && neg->getRawSubclassOptionalData() == 0 &&
+          isa<Constant>(neg->getOperand(0)) && cast<Constant>(neg->getOperand(0))->isNullValue() &&
+          !reads_numbered_load(neg)){
+        e.opcode = Instruction::Sub;
+        e.operands = {e.operands[ 1 - i ], neg->getOperand(1)};
+        return;
+      }
+    }
+  }
+
+  order_operands(e);
+  bool reassociates = e.opcode == Instruction::Add || e.opcode == Instruction::Mul ||
+                      e.opcode == Instruction::And || e.opcode == Instruction::Or ||
+                      e.opcode == Instruction::Xor;
+  if (reassociates && e.flags == 0 && llvm::isa<ConstantInt>(e.operands[1])){
+    BinaryOperator* inner_inst = dyn_cast<BinaryOperator>(e.operands[0]);
+    if (inner_inst && is_candidate(inner_inst) && !reads_numbered_load(inner_inst)){
+      Expression inner = make_expression(inner_inst);
+      if (inner.opcode == e.opcode && inner.flags == 0 && llvm::isa<ConstantInt>(inner.operands[1])){
+        e.operands = {inner.operands[0],
+                      ConstantExpr::get(e.opcode, cast<Constant>(inner.operands[1]), cast<Constant>(e.operands[1]))};
+      }
+    }
+  }
+}
+
+Expression make_expression(llvm::Instruction* inst)
+{
+  Expression e;
+  e.opcode = inst->getOpcode();
+  e.flags = inst->getRawSubclassOptionalData();
+  e.type = inst->getType();
+  e.operands.assign(inst->op_begin(), inst->op_end());
+  for (auto &op : e.operands){
+    if (numbered_load(op)){
+      op = load_leader[ op ];
+    }
+  }
+
+  /* a < b and b > a are the same comparison, constants go right */
+  if (CmpInst* cmp = dyn_cast<CmpInst>(inst)){
+    e.predicate = cmp->getPredicate();
+    bool constant0 = llvm::isa<llvm::Constant>(e.operands[0]);
+    bool constant1 = llvm::isa<llvm::Constant>(e.operands[1]);
+    if ((constant0 && !constant1) || (constant0 == constant1 && e.operands[1] < e.operands[0])){
+      std::swap(e.operands[0], e.operands[1]);
+      e.predicate = CmpInst::getSwappedPredicate(cmp->getPredicate());
+    }
+    return e;
+  }
+
+  /* address arithmetic and casts match operand for operand */
+  if (GetElementPtrInst* gep = dyn_cast<GetElementPtrInst>(inst)){
+    e.indexed_type = gep->getSourceElementType();
+    return e;
+  }
+  if (llvm::isa<llvm::CastInst>(inst)){
+    return e;
+  }
+  /* callee and arguments; readonly calls also see memory */
+  if (CallInst* call = dyn_cast<CallInst>(inst)){
+    e.reads_memory = !call->doesNotAccessMemory();
+    return e;
+  }
+
+  if (Canonicalize){
+    canonicalize(e);
+    return e;
+  }
+
+  /* B op C and C op B are the same computation for commutative operators */
+  if (inst->isCommutative() && e.operands[1] < e.operands[0]){
+    std::swap(e.operands[0], e.operands[1]);
+  }
+  return e;
+}
+
+/* value (re)defined by an instruction, an expression using it is killed.
+   A numbered load defines nothing, the store to its local does. */
+llvm::Value* defined_value(llvm::Instruction* inst)
+{
+  if (!load_leader.empty()){
+    if (StoreInst* store_instruction = dyn_cast<StoreInst>(inst)){
+      return store_instruction->getPointerOperand();
+    }
+    if (numbered_load(inst)){
+      return nullptr;
+    }
+  }
+  return inst;
+}
+
+/* value whose redefinition changes the operand op of an expression */
+llvm::Value* operand_def(llvm::Value* op)
+{
+  LoadInst* load_instruction = numbered_load(op);
+  return load_instruction ? load_instruction->getPointerOperand() : op;
+}
+
+bool kills_expression(llvm::Instruction* inst, const Expression& e)
+{
+  if (e.reads_memory && clobbers_memory(inst)){
+    return true;
+  }
+  llvm::Value* def = defined_value(inst);
+  if (def == nullptr){
+    return false;
+  }
+  for (auto *op : e.operands){
+    if (operand_def(op) == def){
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Reuse an earlier computation of the same expression in the same block.
+   Returns the number of instructions removed. */
+int local_cse(Function &F)
+{
+  int removed = 0;
+  for (auto &basic_block : F){
+    ExpressionMap<llvm::Instruction*> avail;
+    for (auto it = basic_block.begin(); it != basic_block.end(); ){
+      llvm::Instruction* inst = &*it++;
+
+      if (is_candidate(inst)){
+        Expression e = make_expression(inst);
+        auto found = avail.find(e);
+        if (found != avail.end()){
+          inst->replaceAllUsesWith(found->second);
+          inst->eraseFromParent();
+          removed++;
+          continue;
+        }
+        avail[ e ] = inst;
+      }
+
+      for (auto a = avail.begin(); a != avail.end(); ){
+        auto current = a++;
+        if (current->second != inst && kills_expression(inst, current->first)){
+          avail.erase(current);
+        }
+      }
+    }
+  }
+  return removed;
+}
+
+/* Can a copy of inst be placed at the end of edge (from, to)? */
+bool can_insert_on_edge(llvm::BasicBlock* from, llvm::BasicBlock* to, llvm::Instruction* inst, DominatorTree &DT)
+{
+  if (llvm::isa<llvm::IndirectBrInst>(from->getTerminator()) ||
+      llvm::isa<llvm::CallBrInst>(from->getTerminator()) || to->isEHPad()){
+    return false;
+  }
+  /* a call moved up must not hang or throw where the original did not run */
+  CallInst* call = dyn_cast<CallInst>(inst);
+  if (call && !(call->hasFnAttr(Attribute::WillReturn) && call->doesNotThrow())){
+    return false;
+  }
+  /* all operands must already be computed at the edge, numbered loads are
+     repeated there by copy_before */
+  for (auto &op : inst->operands()){
+    llvm::Instruction* def = dyn_cast<Instruction>(op.get());
+    if (def && !numbered_load(def) && !DT.dominates(def->getParent(), from)){
+      return false;
+    }
+  }
+  return true;
+}
+
+/* copy of inst placed before point. Numbered loads among its operands are
+   loaded again at point: the expression is anticipated there, so no store to
+   their locals comes between point and the computations it stands for. */
+llvm::Instruction* copy_before(llvm::Instruction* inst, llvm::Instruction* point)
+{
+  llvm::Instruction* copy = inst->clone();
+  for (auto &op : copy->operands()){
+    if (LoadInst* load_instruction = numbered_load(op.get())){
+      op.set(new LoadInst(load_instruction->getType(), load_instruction->getPointerOperand(), "", point));
+    }
+  }
+  copy->insertBefore(point);
+  return copy;
+}
+
+/* number of the expression computed by inst, -1 if it is not a candidate,
+   was not numbered or sits in a block that is not optimised */
+int numbered_expression(llvm::Instruction* inst, ExpressionMap<int>& expr_id,
+                        SmallPtrSetImpl<llvm::BasicBlock*>& hot)
+{
+  if (!is_candidate(inst) || hot.count(inst->getParent()) == 0){
+    return -1;
+  }
+  auto found = expr_id.find(make_expression(inst));
+  return found == expr_id.end() ? -1 : found->second;
+}
+
+/* Lazy code motion over bit vectors of expressions (Knoop, Ruething, Steffen).
+   Local properties per block:
+     ANTLOC - expression computed before any operand is redefined
+     COMP   - expression computed after the last redefinition
+     TRANSP - no operand is redefined
+   Global properties:
+     AVIN/AVOUT   - available on every path reaching the block
+     ANTIN/ANTOUT - anticipated on every path leaving the block
+     EARLIEST(i,j), LATER(i,j), LATERIN - earliest and latest safe placement
+   Computations are inserted on edges in INSERT(i,j) = LATER(i,j) - LATERIN(j)
+   and the upward exposed computations in DELETE(B) = ANTLOC(B) - LATERIN(B)
+   are replaced by a temporary. Returns the number of deleted computations.
+   Only expressions computed in hot_blocks are numbered, hottest block first
+   and at most budget of them (0 = no limit); computations in other blocks
+   are left alone and treated like any other instruction. If a dataflow
+   problem exceeds limits the function is left unchanged and gave_up names
+   the limit. */
+int lazy_code_motion(Function &F, DominatorTree &DT, int &inserted,
+                     const std::vector<llvm::BasicBlock*>& hot_blocks, int budget,
+                     const AnalysisBudget& limits, std::string& gave_up)
+{
+  typedef std::pair<llvm::BasicBlock*, llvm::BasicBlock*> Edge;
+
+  /* number the expressions in order of first appearance */
+  ExpressionMap<int> expr_id;
+  std::vector<llvm::Instruction*> representative;
+  DenseMap<llvm::Value*, SmallVector<int, 4>> killed_by;
+  SmallVector<int, 4> reads_memory;
+  SmallPtrSet<llvm::BasicBlock*, 32> hot(hot_blocks.begin(), hot_blocks.end());
+  for (auto *basic_block : hot_blocks){
+    for (auto &inst : *basic_block){
+      if (!is_candidate(&inst)){
+        continue;
+      }
+      Expression e = make_expression(&inst);
+      if (expr_id.find(e) == expr_id.end()){
+        if (budget > 0 && (int)representative.size() >= budget){
+          continue;
+        }
+        int id = representative.size();
+        expr_id[ e ] = id;
+        representative.push_back(&inst);
+        for (auto *op : e.operands){
+          killed_by[ operand_def(op) ].push_back(id);
+        }
+        if (e.reads_memory){
+          reads_memory.push_back(id);
+        }
+      }
+    }
+  }
+  int n = representative.size();
+  if (n == 0){
+    return 0;
+  }
+
+  /* local properties */
+  DenseMap<llvm::BasicBlock*, BitVector> ANTLOC, COMP, TRANSP;
+  DenseMap<std::pair<llvm::BasicBlock*, int>, llvm::Instruction*> first_occurrence;
+  for (auto &basic_block : F){
+    BitVector antloc(n), comp(n), transp(n, true), killed(n);
+    for (auto &inst : basic_block){
+      int id = numbered_expression(&inst, expr_id, hot);
+      if (id >= 0){
+        if (!killed.test(id)){
+          antloc.set(id);
+          first_occurrence.insert(std::make_pair(std::make_pair(&basic_block, id), &inst));
+        }
+        comp.set(id);
+      }
+      SmallVector<int, 8> kills;
+      llvm::Value* def = defined_value(&inst);
+      auto k = def ? killed_by.find(def) : killed_by.end();
+      if (k != killed_by.end()){
+        kills.append(k->second.begin(), k->second.end());
+      }
+      if (!reads_memory.empty() && clobbers_memory(&inst)){
+        kills.append(reads_memory.begin(), reads_memory.end());
+      }
+      for (int id : kills){
+        killed.set(id);
+        transp.reset(id);
+        comp.reset(id);
+      }
+    }
+    ANTLOC[ &basic_block ] = antloc;
+    COMP[ &basic_block ] = comp;
+    TRANSP[ &basic_block ] = transp;
+  }
+
+  llvm::BasicBlock* entry = &F.getEntryBlock();
+
+  /* availability, forward must problem */
+  DenseMap<llvm::BasicBlock*, BitVector> AVIN, AVOUT;
+  for (auto &basic_block : F){
+    AVOUT[ &basic_block ] = BitVector(n, true);
+  }
+  bool changed = true;
+  unsigned sweeps = 0;
+  while (changed){
+    changed = false;
+    gave_up = limits.exceeded(0, 0, ++sweeps);
+    if (!gave_up.empty()){
+      return 0;
+    }
+    for (auto &basic_block : F){
+      BitVector in(n, &basic_block != entry);
+      for (auto *pred : predecessors(&basic_block)){
+        in &= AVOUT[ pred ];
+      }
+      BitVector out = in;
+      out &= TRANSP[ &basic_block ];
+      out |= COMP[ &basic_block ];
+      AVIN[ &basic_block ] = in;
+      if (out != AVOUT[ &basic_block ]){
+        AVOUT[ &basic_block ] = out;
+        changed = true;
+      }
+    }
+  }
+
+  /* anticipability, backward must problem */
+  DenseMap<llvm::BasicBlock*, BitVector> ANTIN, ANTOUT;
+  for (auto &basic_block : F){
+    ANTIN[ &basic_block ] = BitVector(n, true);
+  }
+  changed = true;
+  sweeps = 0;
+  while (changed){
+    changed = false;
+    gave_up = limits.exceeded(0, 0, ++sweeps);
+    if (!gave_up.empty()){
+      return 0;
+    }
+    for (auto it = F.getBasicBlockList().rbegin(); it != F.getBasicBlockList().rend(); ++it){
+      llvm::BasicBlock* bb = &*it;
+      BitVector out(n, succ_begin(bb) != succ_end(bb));
+      for (auto *succ : successors(bb)){
+        out &= ANTIN[ succ ];
+      }
+      BitVector in = out;
+      in &= TRANSP[ bb ];
+      in |= ANTLOC[ bb ];
+      ANTOUT[ bb ] = out;
+      if (in != ANTIN[ bb ]){
+        ANTIN[ bb ] = in;
+        changed = true;
+      }
+    }
+  }
+
+  /* EARLIEST(i,j) = ANTIN(j) & ~AVOUT(i) & (~TRANSP(i) | ~ANTOUT(i)) */
+  DenseMap<Edge, BitVector> EARLIEST;
+  for (auto &basic_block : F){
+    for (auto *succ : successors(&basic_block)){
+      BitVector not_transp_or_ant = TRANSP[ &basic_block ];
+      not_transp_or_ant &= ANTOUT[ &basic_block ];
+      not_transp_or_ant.flip();
+
+      BitVector earliest = ANTIN[ succ ];
+      earliest.reset(AVOUT[ &basic_block ]);
+      earliest &= not_transp_or_ant;
+      EARLIEST[ Edge(&basic_block, succ) ] = earliest;
+    }
+  }
+
+  /* LATERIN(j) = AND over preds LATER(i,j)
+     LATER(i,j) = EARLIEST(i,j) | (LATERIN(i) & ~ANTLOC(i)) */
+  DenseMap<llvm::BasicBlock*, BitVector> LATERIN;
+  DenseMap<Edge, BitVector> LATER;
+  for (auto &basic_block : F){
+    LATERIN[ &basic_block ] = BitVector(n, true);
+  }
+  LATERIN[ entry ] = ANTIN[ entry ];
+  changed = true;
+  sweeps = 0;
+  while (changed){
+    changed = false;
+    gave_up = limits.exceeded(0, 0, ++sweeps);
+    if (!gave_up.empty()){
+      return 0;
+    }
+    for (auto &basic_block : F){
+      for (auto *succ : successors(&basic_block)){
+        BitVector later = LATERIN[ &basic_block ];
+        later.reset(ANTLOC[ &basic_block ]);
+        later |= EARLIEST[ Edge(&basic_block, succ) ];
+        LATER[ Edge(&basic_block, succ) ] = later;
+      }
+      if (&basic_block == entry){
+        continue;
+      }
+      BitVector in(n, true);
+      for (auto *pred : predecessors(&basic_block)){
+        auto later = LATER.find(Edge(pred, &basic_block));
+        if (later != LATER.end()){
+          in &= later->second;
+        }
+      }
+      if (in != LATERIN[ &basic_block ]){
+        LATERIN[ &basic_block ] = in;
+        changed = true;
+      }
+    }
+  }
+
+  /* INSERT and DELETE sets per expression */
+  std::vector<std::vector<Edge>> insert_edges(n);
+  std::vector<std::vector<llvm::Instruction*>> deletions(n);
+  for (auto &basic_block : F){
+    for (auto *succ : successors(&basic_block)){
+      BitVector insert = LATER[ Edge(&basic_block, succ) ];
+      insert.reset(LATERIN[ succ ]);
+      for (int id : insert.set_bits()){
+        insert_edges[ id ].push_back(Edge(&basic_block, succ));
+      }
+    }
+  }
+  for (auto &basic_block : F){
+    if (&basic_block == entry){
+      continue;
+    }
+    BitVector del = ANTLOC[ &basic_block ];
+    del.reset(LATERIN[ &basic_block ]);
+    for (int id : del.set_bits()){
+      deletions[ id ].push_back(first_occurrence[ std::make_pair(&basic_block, id) ]);
+    }
+  }
+
+  /* an expression is only rewritten if every insertion is possible */
+  std::vector<bool> rewrite(n, false);
+  for (int id = 0; id < n; id++){
+    if (deletions[ id ].empty()){
+      continue;
+    }
+    rewrite[ id ] = true;
+    for (auto &edge : insert_edges[ id ]){
+      if (!can_insert_on_edge(edge.first, edge.second, representative[ id ], DT)){
+        rewrite[ id ] = false;
+      }
+    }
+  }
+
+  /* remember every remaining computation before the CFG changes */
+  std::vector<std::vector<llvm::Instruction*>> computations(n);
+  for (auto &basic_block : F){
+    for (auto &inst : basic_block){
+      int id = numbered_expression(&inst, expr_id, hot);
+      if (id >= 0 && rewrite[ id ]){
+        computations[ id ].push_back(&inst);
+      }
+    }
+  }
+
+  /* insertion points, critical edges get a block of their own */
+  DenseMap<Edge, llvm::Instruction*> edge_insert_point;
+  auto insert_point = [&](const Edge& edge) -> llvm::Instruction* {
+    auto found = edge_insert_point.find(edge);
+    if (found != edge_insert_point.end()){
+      return found->second;
+    }
+    llvm::Instruction* point;
+    if (edge.first->getTerminator()->getNumSuccessors() == 1){
+      point = edge.first->getTerminator();
+    }else if (edge.second->getSinglePredecessor()){
+      point = &*edge.second->getFirstInsertionPt();
+    }else{
+      llvm::BasicBlock* split = SplitEdge(edge.first, edge.second);
+      point = split->getTerminator();
+    }
+    edge_insert_point[ edge ] = point;
+    return point;
+  };
+
+  llvm::Instruction* alloca_point = &*entry->getFirstInsertionPt();
+  int deleted = 0;
+  for (int id = 0; id < n; id++){
+    if (!rewrite[ id ]){
+      continue;
+    }
+
+    llvm::Instruction* rep = representative[ id ];
+    AllocaInst* temp = new AllocaInst(rep->getType(), F.getParent()->getDataLayout().getAllocaAddrSpace(),
+                                      "t", alloca_point);
+
+    /* every computation that stays saves its value in the temporary */
+    for (auto *inst : computations[ id ]){
+      if (std::find(deletions[ id ].begin(), deletions[ id ].end(), inst) == deletions[ id ].end()){
+        new StoreInst(inst, temp, inst->getNextNode());
+      }
+    }
+    for (auto &edge : insert_edges[ id ]){
+      llvm::Instruction* copy = copy_before(rep, insert_point(edge));
+      new StoreInst(copy, temp, copy->getNextNode());
+      inserted++;
+    }
+
+    /* fully redundant now, read the temporary instead */
+    for (auto *inst : deletions[ id ]){
+      LoadInst* reload = new LoadInst(rep->getType(), temp, "", inst);
+      inst->replaceAllUsesWith(reload);
+      inst->eraseFromParent();
+      deleted++;
+    }
+  }
+  return deleted;
+}
+
+/* ---------------- Comparisons implied by branch conditions ---------------- */
+
+/* outcome of comparison x when the fact holds: 1 true, 0 false, -1 unknown */
+int implied_outcome(const Expression& fact, const Expression& x)
+{
+  if (fact.opcode != x.opcode || fact.operands != x.operands){
+    return -1;
+  }
+  CmpInst::Predicate known = (CmpInst::Predicate)fact.predicate;
+  CmpInst::Predicate asked = (CmpInst::Predicate)x.predicate;
+  if (CmpInst::isImpliedTrueByMatchingCmp(known, asked)){
+    return 1;
+  }
+  if (CmpInst::isImpliedFalseByMatchingCmp(known, asked)){
+    return 0;
+  }
+  return -1;
+}
+
+/* Fold comparisons whose outcome follows from the branches taken to reach
+   them. A conditional branch on a comparison c in the same block gives c on
+   the edge to its true successor and the inverse of c on the edge to its
+   false successor. Facts flow forward like available expressions: a fact
+   holds at a block if it holds on every incoming edge, and a redefinition
+   of an operand kills it. Operands are numbered as for -cse-match-loads, so
+   x > 3 tested again after a fresh load of x is still known. Constant
+   branches are then removed together with the blocks they cut off.
+   Returns the number of comparisons folded and adds the removed branches to
+   branches; nothing is folded if an analysis exceeds limits, gave_up then
+   names the limit. */
+int fold_implied_compares(Function &F, int &branches, const AnalysisBudget& limits, std::string& gave_up)
+{
+  typedef std::pair<llvm::BasicBlock*, llvm::BasicBlock*> Edge;
+
+  std::string loads_gave_up;
+  number_loads(F, limits, loads_gave_up);
+
+  /* facts, one per comparison and outcome, generated on branch edges */
+  ExpressionMap<int> fact_id;
+  std::vector<Expression> facts;
+  DenseMap<Edge, SmallVector<int, 2>> generated;
+  for (auto &basic_block : F){
+    BranchInst* branch = dyn_cast<BranchInst>(basic_block.getTerminator());
+    CmpInst* cond = branch && branch->isConditional() ? dyn_cast<CmpInst>(branch->getCondition()) : nullptr;
+    if (cond == nullptr || cond->getParent() != &basic_block ||
+        branch->getSuccessor(0) == branch->getSuccessor(1)){
+      continue;
+    }
+    Expression e = make_expression(cond);
+    bool killed = false;
+    for (auto it = std::next(cond->getIterator()); it != basic_block.end(); ++it){
+      killed = killed || kills_expression(&*it, e);
+    }
+    if (killed){
+      continue;
+    }
+    for (unsigned s = 0; s < 2; s++){
+      Expression fact = e;
+      if (s == 1){
+        fact.predicate = CmpInst::getInversePredicate((CmpInst::Predicate)e.predicate);
+      }
+      auto inserted = fact_id.insert(std::make_pair(fact, (int)facts.size()));
+      if (inserted.second){
+        facts.push_back(fact);
+      }
+      generated[ Edge(&basic_block, branch->getSuccessor(s)) ].push_back(inserted.first->second);
+    }
+  }
+  int n = facts.size();
+  if (n == 0){
+    remove_unused_loads();
+    return 0;
+  }
+
+  DenseMap<llvm::BasicBlock*, BitVector> TRANSP;
+  for (auto &basic_block : F){
+    BitVector transp(n, true);
+    for (auto &inst : basic_block){
+      for (int id = 0; id < n; id++){
+        if (transp.test(id) && kills_expression(&inst, facts[ id ])){
+          transp.reset(id);
+        }
+      }
+    }
+    TRANSP[ &basic_block ] = transp;
+  }
+
+  /* forward must problem, facts on an edge are FOUT(pred) plus its own */
+  llvm::BasicBlock* entry = &F.getEntryBlock();
+  DenseMap<llvm::BasicBlock*, BitVector> FIN, FOUT;
+  for (auto &basic_block : F){
+    FOUT[ &basic_block ] = BitVector(n, true);
+  }
+  bool changed = true;
+  unsigned sweeps = 0;
+  while (changed){
+    changed = false;
+    gave_up = limits.exceeded(0, 0, ++sweeps);
+    if (!gave_up.empty()){
+      remove_unused_loads();
+      return 0;
+    }
+    for (auto &basic_block : F){
+      BitVector in(n, &basic_block != entry);
+      for (auto *pred : predecessors(&basic_block)){
+        BitVector edge = FOUT[ pred ];
+        auto gen = generated.find(Edge(pred, &basic_block));
+        if (gen != generated.end()){
+          for (int id : gen->second){
+            edge.set(id);
+          }
+        }
+        in &= edge;
+      }
+      BitVector out = in;
+      out &= TRANSP[ &basic_block ];
+      FIN[ &basic_block ] = in;
+      if (out != FOUT[ &basic_block ]){
+        FOUT[ &basic_block ] = out;
+        changed = true;
+      }
+    }
+  }
+
+  /* fold the comparisons a fact decides */
+  std::vector<std::pair<llvm::Instruction*, bool>> folds;
+  for (auto &basic_block : F){
+    BitVector known = FIN[ &basic_block ];
+    for (auto &inst : basic_block){
+      if (llvm::isa<llvm::CmpInst>(&inst) && known.any()){
+        Expression x = make_expression(&inst);
+        for (int id : known.set_bits()){
+          int outcome = implied_outcome(facts[ id ], x);
+          if (outcome >= 0){
+            folds.push_back(std::make_pair(&inst, outcome == 1));
+            break;
+          }
+        }
+      }
+      for (int id : known.set_bits()){
+        if (kills_expression(&inst, facts[ id ])){
+          known.reset(id);
+        }
+      }
+    }
+  }
+  for (auto &fold : folds){
+    fold.first->replaceAllUsesWith(ConstantInt::getBool(fold.first->getType(), fold.second));
+    fold.first->eraseFromParent();
+  }
+  remove_unused_loads();
+
+  if (!folds.empty()){
+    for (auto &basic_block : F){
+      BranchInst* branch = dyn_cast<BranchInst>(basic_block.getTerminator());
+      if (branch && branch->isConditional() && llvm::isa<llvm::Constant>(branch->getCondition()) &&
+          ConstantFoldTerminator(&basic_block, true)){
+        branches++;
+      }
+    }
+    removeUnreachableBlocks(F);
+  }
+  return folds.size();
+}
+
+/* forget blocks that are no longer in F */
+void drop_removed_blocks(Function &F, std::vector<llvm::BasicBlock*>& blocks)
+{
+  SmallPtrSet<llvm::BasicBlock*, 32> live;
+  for (auto &basic_block : F){
+    live.insert(&basic_block);
+  }
+  blocks.erase(std::remove_if(blocks.begin(), blocks.end(),
+                              [&](llvm::BasicBlock* bb){ return live.count(bb) == 0; }),
+               blocks.end());
+}
+
+bool profile_guided()
+{
+  return !ProfileFile.empty() || HotThreshold > 0 || WorkBudget > 0;
+}
+
+/* -cse-pre, set or implied by a flag that only refines it */
+bool partial_redundancy()
+{
+  return PartialRedundancy || Canonicalize || MatchLoads || MatchAddresses || PureCalls;
+}
+
 struct CSElimination : public FunctionPass
 {
   static char ID;
   CSElimination() : FunctionPass(ID) {}
 
+  /* edge counts of -cse-profile, read on first use */
+  std::map<std::string, std::vector<uint64_t>> profile;
+  bool profile_read = false;
+
+  /* flags that only refine the expression based stages turn on -cse-pre,
+     say so once */
+  bool doInitialization(Module &M) override
+  {
+    if (!PartialRedundancy){
+      if (Canonicalize){
+        errs() << "-cse-canonical needs -cse-pre, turning it on\n";
+      }
+      if (MatchLoads){
+        errs() << "-cse-match-loads needs -cse-pre, turning it on\n";
+      }
+      if (MatchAddresses){
+        errs() << "-cse-addresses needs -cse-pre, turning it on\n";
+      }
+      if (PureCalls){
+        errs() << "-cse-pure-calls needs -cse-pre, turning it on\n";
+      }
+    }
+    return false;
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override
+  {
+    AU.addRequired<DominatorTreeWrapperPass>();
+    if (profile_guided()){
+      AU.addRequired<BlockFrequencyInfoWrapperPass>();
+    }
+  }
+
+  /* execution count of every block, measured if the profile has F,
+     estimated by BlockFrequencyInfo otherwise. Returns the entry count */
+  uint64_t get_block_frequencies(Function &F, DenseMap<llvm::BasicBlock*, uint64_t>& freq)
+  {
+    if (!ProfileFile.empty()){
+      if (!profile_read){
+        profile_read = true;
+        if (!read_edge_profile(ProfileFile, profile)){
+          errs() << "cannot read profile " << ProfileFile << "\n";
+        }
+      }
+      auto found = profile.find(F.getName().str());
+      if (found != profile.end() && compute_block_frequencies(F, found->second, freq)){
+        return freq[ &F.getEntryBlock() ];
+      }
+      errs() << "no profile, using estimated frequencies\n";
+      freq.clear();
+    }
+
+    BlockFrequencyInfo &BFI = getAnalysis<BlockFrequencyInfoWrapperPass>().getBFI();
+    for (auto &basic_block : F){
+      freq[ &basic_block ] = BFI.getBlockFreq(&basic_block).getFrequency();
+    }
+    return BFI.getEntryFreq();
+  }
+
+  /* blocks worth optimising, hottest first; every block in layout order
+     unless profile guided */
+  std::vector<llvm::BasicBlock*> get_hot_blocks(Function &F)
+  {
+    std::vector<llvm::BasicBlock*> blocks;
+    for (auto &basic_block : F){
+      blocks.push_back(&basic_block);
+    }
+    if (!profile_guided()){
+      return blocks;
+    }
+
+    DenseMap<llvm::BasicBlock*, uint64_t> freq;
+    uint64_t entry_freq = get_block_frequencies(F, freq);
+    std::stable_sort(blocks.begin(), blocks.end(), [&](llvm::BasicBlock* a, llvm::BasicBlock* b){
+      return freq.lookup(a) > freq.lookup(b);
+    });
+
+    /* a block that never ran is cold whatever the threshold */
+    std::vector<llvm::BasicBlock*> hot;
+    for (auto *bb : blocks){
+      if (HotThreshold <= 0 || (freq[ bb ] > 0 && freq[ bb ] >= HotThreshold * entry_freq)){
+        hot.push_back(bb);
+      }
+    }
+    errs() << "Hot blocks: " << hot.size() << " of " << blocks.size() << "\n";
+    return hot;
+  }
+
   bool runOnFunction(Function &F) override
+  {
+    bool changed = eliminate(F);
+    load_leader.clear();
+
+    /* self check: whatever the stages did, F must still be valid IR */
+    if (VerifyOutput){
+      NumVerified++;
+      if (verifyFunction(F, &errs())){
+        report_fatal_error(Twine("CSElimination produced invalid IR in ") + F.getName());
+      }
+    }
+    return changed;
+  }
+
+  bool eliminate(Function &F)
   {
     errs() << "CSE Elimination: By Anvaya and Arnav : Compiler Construction Phase-III: ";
     errs() << F.getName() << "\n";
 
+    AnalysisBudget budget;
+    budget.max_blocks = MaxBlocks;
+    budget.max_items = MaxInstructions;
+    budget.max_iterations = MaxIterations;
+    budget.max_seconds = MaxTime;
+
+    /* too large for any global stage, fall back to one pass per block */
+    std::string gave_up = budget.exceeded(F.size(), F.getInstructionCount(), 0);
+    if (!gave_up.empty()){
+      int local = local_cse(F);
+      errs() << "Budget exceeded (" << gave_up << "), local CSE only, removed: " << local << "\n";
+      NumLocalOnly++;
+      F.print(errs());
+      return local != 0;
+    }
+
+    /* ranked while the CFG is still the one the profile was taken on */
+    std::vector<llvm::BasicBlock*> hot_blocks = get_hot_blocks(F);
+
+    /* copy propagation stage, runs before the maps below are built */
+    if (CopyPropagation){
+      DominatorTree &DT = getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+      int forwarded = 0;
+      int forwarded_this_round;
+      do {
+        forwarded_this_round = propagate_copies(F, DT, budget, gave_up);
+        forwarded += forwarded_this_round;
+      } while (forwarded_this_round != 0);
+      int removed = remove_dead_stores(F);
+      errs() << "Copies propagated: " << forwarded << ", dead stores removed: " << removed << "\n";
+      if (!gave_up.empty()){
+        errs() << "Budget exceeded (" << gave_up << "), copy propagation stopped\n";
+        NumCopyPropSkipped++;
+        gave_up.clear();
+      }
+    }
+
+    /* comparison folding stage, may remove branches and blocks */
+    if (FoldCompares){
+      int branches = 0;
+      int folded = fold_implied_compares(F, branches, budget, gave_up);
+      NumComparesFolded += folded;
+      NumBranchesFolded += branches;
+      errs() << "Comparisons folded: " << folded << ", branches removed: " << branches << "\n";
+      if (!gave_up.empty()){
+        errs() << "Budget exceeded (" << gave_up << "), comparisons not folded\n";
+        gave_up.clear();
+      }
+      drop_removed_blocks(F, hot_blocks);
+    }
+
+    /* PRE mode replaces the elimination scheme below */
+    if (partial_redundancy()){
+      removeUnreachableBlocks(F);
+      drop_removed_blocks(F, hot_blocks);
+
+      /* loads are numbered before local CSE so both stages match them */
+      if (MatchLoads){
+        int matched = number_loads(F, budget, gave_up);
+        NumLoadsMatched += matched;
+        errs() << "Loads matched: " << matched << "\n";
+        if (!gave_up.empty()){
+          errs() << "Budget exceeded (" << gave_up << "), loads not matched\n";
+          gave_up.clear();
+        }
+      }
+
+      DominatorTree DT(F);
+      int local = local_cse(F);
+      int inserted = 0;
+      int deleted = lazy_code_motion(F, DT, inserted, hot_blocks, WorkBudget, budget, gave_up);
+      remove_unused_loads();
+      errs() << "Local CSE removed: " << local << ", PRE inserted: " << inserted
+             << ", PRE deleted: " << deleted << "\n";
+      if (!gave_up.empty()){
+        errs() << "Budget exceeded (" << gave_up << "), PRE skipped\n";
+        NumPRESkipped++;
+      }
+      F.print(errs());
+      return true;
+    }
+
     /* just collect all the information here */
+    global_numbering.number(F);
+    global_block_map.clear();
     int i = 0 ;
     for (auto &basic_block : F){
-
-      /* map <index, inst> */
-      std::map<int, llvm::Instruction*> inst_map;
-      std::map<int, llvm::Instruction*> inst_op_map;
-      std::map<int, llvm::Instruction*> inst_stor_map;
-      std::map<int, llvm::Instruction*> inst_load_map;
+      BlockInstructions& block_insts = global_block_map[ &basic_block ];
 
       for (auto &inst : basic_block){
-        /* insert all instructions to this map */
-        inst_map[ i ] = &inst;
-
         /* if instruction is a operation store in */
         if (llvm::isa<llvm::BinaryOperator>(inst)){
 
-          /* add to inst op map*/
-          inst_op_map[ i ] = &inst; 
+          /* add to inst op list*/
+          block_insts.ops.push_back(i);
         
         }else if (llvm::isa<llvm::StoreInst>(inst)){
 
-          /* add to store map*/
-          inst_stor_map[ i ] = &inst; 
+          /* add to store list*/
+          block_insts.stores.push_back(i);
         
         }else if (llvm::isa<llvm::LoadInst>(inst)){
-          /* add to load map*/
-          inst_load_map[ i ] = &inst;
+          /* add to load list*/
+          block_insts.loads.push_back(i);
         }
         
         i++;
       }
-
-      /* insert the inst_map to global basic block instruction map */
-      global_inst_map[ &basic_block ] = inst_map; 
-      global_inst_op_map[ &basic_block ] = inst_op_map;
-      global_inst_stor_map[ &basic_block ] = inst_stor_map;
-      global_inst_load_map[ &basic_block ] = inst_load_map;
     }
     
     // F.print(errs());
 
     /* CS Elimination algorithm */
 
-    /* index */
-    i = 0 ; 
-    /* for each block */
-    for (auto &basic_block : F){
-
+    /* for each block, hottest first, until the work budget runs out */
+    int considered = 0;
+    for (auto *hot_block : hot_blocks){
+      llvm::BasicBlock &basic_block = *hot_block;
 
-      for (auto &inst : basic_block){
+      /* by index: the rewrite below adds loads and stores that have none */
+      unsigned block_end = global_numbering.block_end(&basic_block);
+      for (i = global_numbering.block_begin(&basic_block); i < (int)block_end; i++){
+        if (WorkBudget > 0 && considered >= WorkBudget){
+          break;
+        }
+        if (gave_up.empty() && budget.out_of_time()){
+          gave_up = "time";
+        }
+        if (!gave_up.empty()){
+          break;
+        }
+        llvm::Instruction* inst = global_numbering[ i ];
         /* if the statement is a operation such as S:A = (B OP C )*/
         if (llvm::isa<llvm::BinaryOperator>(inst)){
+          considered++;
           /* if BOP is available at entry of this BB */
           bool avai = available_at_entry(&basic_block, i); 
           /* get the operands' name and the operation */
@@ -288,18 +1588,22 @@ struct CSElimination : public FunctionPass
             /* create a temporary var */
             std::string t = "t";
 
-            /* replace each statement D = B OP C */
-            replace_each_statement(def, t, &basic_block); 
-
-            /* replace the right hand */
-            // replace_right_hand_side(t); 
-
+            /* replace each statement D = B OP C, and S by a read of t */
+            if (replace_each_statement(def, t, &basic_block, i)){
+              NumStatementsReplaced++;
+            }
           }
           
         }
-        i++; 
       }
     }    
+    if (WorkBudget > 0 && considered >= WorkBudget){
+      errs() << "Work budget exhausted after " << considered << " candidates\n";
+    }
+    if (!gave_up.empty()){
+      errs() << "Budget exceeded (" << gave_up << "), elimination stopped after " << considered << " candidates\n";
+      NumEliminationStopped++;
+    }
     F.print(errs());
     return true; // Indicate this is a Transform pass
   }
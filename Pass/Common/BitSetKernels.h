@@ -0,0 +1,269 @@
+#ifndef BITSET_KERNELS_H
+#define BITSET_KERNELS_H
+
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define BITSET_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+/* Word loops over bit sets of n 64-bit words, the inner loops of the
+   dataflow problems:
+     union_with - dst |= src
+     subtract   - dst &= ~src
+     transfer   - out = gen | (in & ~kill)
+     equals     - a == b, the change test of a fixpoint iteration
+     count      - number of set bits
+   There is a scalar version of every kernel and, on x86-64, SSE2 and AVX2
+   versions. The best one the CPU supports is picked on first use. */
+struct BitSetKernels
+{
+  const char* name;
+  void (*union_with)(uint64_t* dst, const uint64_t* src, unsigned n);
+  void (*subtract)(uint64_t* dst, const uint64_t* src, unsigned n);
+  void (*transfer)(uint64_t* out, const uint64_t* gen, const uint64_t* in, const uint64_t* kill, unsigned n);
+  bool (*equals)(const uint64_t* a, const uint64_t* b, unsigned n);
+  unsigned (*count)(const uint64_t* a, unsigned n);
+};
+
+namespace bitset_impl
+{
+
+inline void scalar_union(uint64_t* dst, const uint64_t* src, unsigned n)
+{
+  for (unsigned w = 0; w < n; w++){
+    dst[ w ] |= src[ w ];
+  }
+}
+
+inline void scalar_subtract(uint64_t* dst, const uint64_t* src, unsigned n)
+{
+  for (unsigned w = 0; w < n; w++){
+    dst[ w ] &= ~src[ w ];
+  }
+}
+
+inline void scalar_transfer(uint64_t* out, const uint64_t* gen, const uint64_t* in, const uint64_t* kill, unsigned n)
+{
+  for (unsigned w = 0; w < n; w++){
+    out[ w ] = gen[ w ] | (in[ w ] & ~kill[ w ]);
+  }
+}
+
+inline bool scalar_equals(const uint64_t* a, const uint64_t* b, unsigned n)
+{
+  return std::memcmp(a, b, n * sizeof(uint64_t)) == 0;
+}
+
+/* SWAR population count, for CPUs without a popcnt instruction */
+inline unsigned scalar_count(const uint64_t* a, unsigned n)
+{
+  unsigned total = 0;
+  for (unsigned w = 0; w < n; w++){
+    uint64_t x = a[ w ];
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    total += (x * 0x0101010101010101ULL) >> 56;
+  }
+  return total;
+}
+
+#ifdef BITSET_KERNELS_X86
+
+/* ---------------- SSE2, 2 words per step ---------------- */
+
+__attribute__((target("sse2")))
+inline void sse2_union(uint64_t* dst, const uint64_t* src, unsigned n)
+{
+  unsigned w = 0;
+  for (; w + 2 <= n; w += 2){
+    __m128i d = _mm_loadu_si128((const __m128i*)(dst + w));
+    __m128i s = _mm_loadu_si128((const __m128i*)(src + w));
+    _mm_storeu_si128((__m128i*)(dst + w), _mm_or_si128(d, s));
+  }
+  scalar_union(dst + w, src + w, n - w);
+}
+
+__attribute__((target("sse2")))
+inline void sse2_subtract(uint64_t* dst, const uint64_t* src, unsigned n)
+{
+  unsigned w = 0;
+  for (; w + 2 <= n; w += 2){
+    __m128i d = _mm_loadu_si128((const __m128i*)(dst + w));
+    __m128i s = _mm_loadu_si128((const __m128i*)(src + w));
+    _mm_storeu_si128((__m128i*)(dst + w), _mm_andnot_si128(s, d));
+  }
+  scalar_subtract(dst + w, src + w, n - w);
+}
+
+__attribute__((target("sse2")))
+inline void sse2_transfer(uint64_t* out, const uint64_t* gen, const uint64_t* in, const uint64_t* kill, unsigned n)
+{
+  unsigned w = 0;
+  for (; w + 2 <= n; w += 2){
+    __m128i g = _mm_loadu_si128((const __m128i*)(gen + w));
+    __m128i i = _mm_loadu_si128((const __m128i*)(in + w));
+    __m128i k = _mm_loadu_si128((const __m128i*)(kill + w));
+    _mm_storeu_si128((__m128i*)(out + w), _mm_or_si128(g, _mm_andnot_si128(k, i)));
+  }
+  scalar_transfer(out + w, gen + w, in + w, kill + w, n - w);
+}
+
+__attribute__((target("sse2")))
+inline bool sse2_equals(const uint64_t* a, const uint64_t* b, unsigned n)
+{
+  unsigned w = 0;
+  for (; w + 2 <= n; w += 2){
+    __m128i x = _mm_loadu_si128((const __m128i*)(a + w));
+    __m128i y = _mm_loadu_si128((const __m128i*)(b + w));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xffff){
+      return false;
+    }
+  }
+  return scalar_equals(a + w, b + w, n - w);
+}
+
+/* ---------------- AVX2, 4 words per step ---------------- */
+
+__attribute__((target("avx2")))
+inline void avx2_union(uint64_t* dst, const uint64_t* src, unsigned n)
+{
+  unsigned w = 0;
+  for (; w + 4 <= n; w += 4){
+    __m256i d = _mm256_loadu_si256((const __m256i*)(dst + w));
+    __m256i s = _mm256_loadu_si256((const __m256i*)(src + w));
+    _mm256_storeu_si256((__m256i*)(dst + w), _mm256_or_si256(d, s));
+  }
+  scalar_union(dst + w, src + w, n - w);
+}
+
+__attribute__((target("avx2")))
+inline void avx2_subtract(uint64_t* dst, const uint64_t* src, unsigned n)
+{
+  unsigned w = 0;
+  for (; w + 4 <= n; w += 4){
+    __m256i d = _mm256_loadu_si256((const __m256i*)(dst + w));
+    __m256i s = _mm256_loadu_si256((const __m256i*)(src + w));
+    _mm256_storeu_si256((__m256i*)(dst + w), _mm256_andnot_si256(s, d));
+  }
+  scalar_subtract(dst + w, src + w, n - w);
+}
+
+__attribute__((target("avx2")))
+inline void avx2_transfer(uint64_t* out, const uint64_t* gen, const uint64_t* in, const uint64_t* kill, unsigned n)
+{
+  unsigned w = 0;
+  for (; w + 4 <= n; w += 4){
+    __m256i g = _mm256_loadu_si256((const __m256i*)(gen + w));
+    __m256i i = _mm256_loadu_si256((const __m256i*)(in + w));
+    __m256i k = _mm256_loadu_si256((const __m256i*)(kill + w));
+    _mm256_storeu_si256((__m256i*)(out + w), _mm256_or_si256(g, _mm256_andnot_si256(k, i)));
+  }
+  scalar_transfer(out + w, gen + w, in + w, kill + w, n - w);
+}
+
+__attribute__((target("avx2")))
+inline bool avx2_equals(const uint64_t* a, const uint64_t* b, unsigned n)
+{
+  unsigned w = 0;
+  for (; w + 4 <= n; w += 4){
+    __m256i x = _mm256_loadu_si256((const __m256i*)(a + w));
+    __m256i y = _mm256_loadu_si256((const __m256i*)(b + w));
+    __m256i diff = _mm256_xor_si256(x, y);
+    if (!_mm256_testz_si256(diff, diff)){
+      return false;
+    }
+  }
+  return scalar_equals(a + w, b + w, n - w);
+}
+
+/* every CPU with AVX2 has popcnt, four independent sums hide its latency */
+__attribute__((target("popcnt")))
+inline unsigned popcnt_count(const uint64_t* a, unsigned n)
+{
+  uint64_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+  unsigned w = 0;
+  for (; w + 4 <= n; w += 4){
+    c0 += _mm_popcnt_u64(a[ w ]);
+    c1 += _mm_popcnt_u64(a[ w + 1 ]);
+    c2 += _mm_popcnt_u64(a[ w + 2 ]);
+    c3 += _mm_popcnt_u64(a[ w + 3 ]);
+  }
+  for (; w < n; w++){
+    c0 += _mm_popcnt_u64(a[ w ]);
+  }
+  return c0 + c1 + c2 + c3;
+}
+
+#endif
+
+} // end of namespace bitset_impl
+
+inline const BitSetKernels& scalar_bitset_kernels()
+{
+  using namespace bitset_impl;
+  static const BitSetKernels kernels = {"scalar", scalar_union, scalar_subtract, scalar_transfer,
+                                        scalar_equals, scalar_count};
+  return kernels;
+}
+
+/* kernels by name ("scalar", "sse2", "avx2"), nullptr if unknown or the
+   CPU cannot run them */
+inline const BitSetKernels* find_bitset_kernels(const char* name)
+{
+  if (std::strcmp(name, "scalar") == 0){
+    return &scalar_bitset_kernels();
+  }
+#ifdef BITSET_KERNELS_X86
+  using namespace bitset_impl;
+  __builtin_cpu_init();
+  if (std::strcmp(name, "sse2") == 0 && __builtin_cpu_supports("sse2")){
+    static const BitSetKernels kernels = {"sse2", sse2_union, sse2_subtract, sse2_transfer,
+                                          sse2_equals, __builtin_cpu_supports("popcnt") ? popcnt_count : scalar_count};
+    return &kernels;
+  }
+  if (std::strcmp(name, "avx2") == 0 && __builtin_cpu_supports("avx2")){
+    static const BitSetKernels kernels = {"avx2", avx2_union, avx2_subtract, avx2_transfer,
+                                          avx2_equals, popcnt_count};
+    return &kernels;
+  }
+#endif
+  return nullptr;
+}
+
+inline const BitSetKernels*& active_bitset_kernels()
+{
+  static const BitSetKernels* active = nullptr;
+  if (active == nullptr){
+    for (const char* name : {"avx2", "sse2", "scalar"}){
+      active = find_bitset_kernels(name);
+      if (active){
+        break;
+      }
+    }
+  }
+  return active;
+}
+
+/* the kernels in use, the best ones unless select_bitset_kernels chose others */
+inline const BitSetKernels& bitset_kernels()
+{
+  return *active_bitset_kernels();
+}
+
+/* use the named kernels from now on, false if they cannot run here */
+inline bool select_bitset_kernels(const char* name)
+{
+  const BitSetKernels* kernels = find_bitset_kernels(name);
+  if (kernels == nullptr){
+    return false;
+  }
+  active_bitset_kernels() = kernels;
+  return true;
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef INSTRUCTION_NUMBERING_H
+#define INSTRUCTION_NUMBERING_H
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include <vector>
+#include <utility>
+
+/* Running index of every instruction of a function, in layout order.
+   instructions - instruction of each index, one contiguous array
+   ranges       - [begin, end) indexes of the instructions of each block
+   index        - reverse map of instruction to index
+   The numbering is a snapshot: instructions added or removed later
+   have no index or a stale one. So what the passes share is this type,
+   not one instance: every analysis numbers the function it sees, and a
+   pass that changes the IR between stages numbers it again. */
+class InstructionNumbering
+{
+public:
+  InstructionNumbering() {}
+  explicit InstructionNumbering(llvm::Function &F) { number(F); }
+
+  void number(llvm::Function &F)
+  {
+    instructions.clear();
+    ranges.clear();
+    index.clear();
+    for (auto &basic_block : F){
+      unsigned begin = instructions.size();
+      for (auto &inst : basic_block){
+        index[ &inst ] = instructions.size();
+        instructions.push_back(&inst);
+      }
+      ranges[ &basic_block ] = std::make_pair(begin, (unsigned)instructions.size());
+    }
+  }
+
+  unsigned size() const { return instructions.size(); }
+  llvm::Instruction* operator[](unsigned i) const { return instructions[ i ]; }
+  llvm::ArrayRef<llvm::Instruction*> all() const { return instructions; }
+
+  /* index of inst, -1 if it was not numbered */
+  int index_of(const llvm::Instruction* inst) const
+  {
+    auto found = index.find(inst);
+    return found == index.end() ? -1 : (int)found->second;
+  }
+
+  unsigned block_begin(const llvm::BasicBlock* bb) const { return ranges.lookup(bb).first; }
+  unsigned block_end(const llvm::BasicBlock* bb) const { return ranges.lookup(bb).second; }
+
+  /* instructions of bb in order */
+  llvm::ArrayRef<llvm::Instruction*> block(const llvm::BasicBlock* bb) const
+  {
+    std::pair<unsigned, unsigned> range = ranges.lookup(bb);
+    return llvm::ArrayRef<llvm::Instruction*>(instructions).slice(range.first, range.second - range.first);
+  }
+
+private:
+  std::vector<llvm::Instruction*> instructions;
+  llvm::DenseMap<const llvm::BasicBlock*, std::pair<unsigned, unsigned>> ranges;
+  llvm::DenseMap<const llvm::Instruction*, unsigned> index;
+};
+
+#endif
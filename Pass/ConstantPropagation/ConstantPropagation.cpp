@@ -0,0 +1,137 @@
+#include "llvm/Pass.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/IR/Type.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/Analysis/ConstantFolding.h"
+#include "llvm/Transforms/Utils/Local.h"
+#include <string>
+#include <vector>
+
+#include "ReachingDefinition/ReachingDefinition.h"
+
+using namespace llvm;
+using namespace std;
+
+#define DEBUG_TYPE "ConstantPropagation"
+
+namespace
+{
+
+/* constant stored by every reaching definition, nullptr if they disagree */
+llvm::Constant* constant_of_defs(const SmallVectorImpl<int>& defs, ReachingDefinitionInfo& info)
+{
+  llvm::Constant* result = nullptr;
+  for (int d : defs){
+    StoreInst* store_instruction = dyn_cast<StoreInst>(info.numbering[ d ]);
+    llvm::Constant* value = dyn_cast<Constant>(store_instruction->getValueOperand());
+    if (value == nullptr || (result != nullptr && value != result)){
+      return nullptr;
+    }
+    result = value;
+  }
+  return result;
+}
+
+struct ConstantPropagation : public FunctionPass
+{
+  static char ID;
+  ConstantPropagation() : FunctionPass(ID) {}
+
+  bool runOnFunction(Function &F) override
+  {
+    errs() << "ConstantPropagation: ";
+    errs() << F.getName() << "\n";
+
+    const DataLayout &DL = F.getParent()->getDataLayout();
+
+    int loads_replaced = 0;
+    int insts_folded = 0;
+    int branches_folded = 0;
+    bool modified = false;
+
+    /* every rewrite can expose new constants, so start over until nothing changes */
+    bool changed = true;
+    while (changed){
+      changed = false;
+
+      ReachingDefinitionInfo info;
+      compute_reaching_definitions(F, info);
+
+      /* replace loads whose reaching definitions all store the same constant */
+      std::vector<std::pair<llvm::LoadInst*, llvm::Constant*>> replacements;
+      for (auto &basic_block : F){
+        for (auto &inst : basic_block){
+          LoadInst* load_instruction = dyn_cast<LoadInst>(&inst);
+          if (load_instruction == nullptr || load_instruction->isVolatile() ||
+              !is_tracked_var(load_instruction->getPointerOperand())){
+            continue;
+          }
+
+          SmallVector<int, 4> defs = defs_reaching_load(load_instruction, info);
+          if (defs.empty()){
+            continue;
+          }
+          llvm::Constant* value = constant_of_defs(defs, info);
+          if (value != nullptr && value->getType() == load_instruction->getType()){
+            replacements.push_back(std::make_pair(load_instruction, value));
+          }
+        }
+      }
+
+      for (auto &pair : replacements){
+        pair.first->replaceAllUsesWith(pair.second);
+        pair.first->eraseFromParent();
+        loads_replaced++;
+        changed = true;
+      }
+
+      /* fold binary operators and compares whose operands became constants */
+      for (auto &basic_block : F){
+        for (auto it = basic_block.begin(); it != basic_block.end(); ){
+          llvm::Instruction* inst = &*it++;
+          if (!inst->isBinaryOp() && !isa<CmpInst>(inst)){
+            continue;
+          }
+          if (llvm::Constant* folded = ConstantFoldInstruction(inst, DL)){
+            inst->replaceAllUsesWith(folded);
+            inst->eraseFromParent();
+            insts_folded++;
+            changed = true;
+          }
+        }
+      }
+
+      /* conditional branches on a constant become unconditional */
+      for (auto &basic_block : F){
+        BranchInst* branch = dyn_cast<BranchInst>(basic_block.getTerminator());
+        if (branch && branch->isConditional() && isa<Constant>(branch->getCondition())){
+          if (ConstantFoldTerminator(&basic_block, true)){
+            branches_folded++;
+            changed = true;
+          }
+        }
+      }
+      if (removeUnreachableBlocks(F)){
+        changed = true;
+      }
+      modified |= changed;
+    }
+
+    errs() << "Loads replaced: " << loads_replaced << "\n";
+    errs() << "Instructions folded: " << insts_folded << "\n";
+    errs() << "Branches folded: " << branches_folded << "\n";
+
+    return modified;
+  }
+}; // end of struct ConstantPropagation
+} // end of anonymous namespace
+
+char ConstantPropagation::ID = 0;
+static RegisterPass<ConstantPropagation> X("ConstantPropagation", "Constant Propagation Pass",
+                                      false /* Only looks at CFG */,
+                                      false /* Analysis Pass */);
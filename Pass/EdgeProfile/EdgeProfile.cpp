@@ -0,0 +1,168 @@
+#include "llvm/Pass.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/IR/Type.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/ModuleUtils.h"
+#include <string>
+#include <map>
+#include <vector>
+
+#include "EdgeProfile/EdgeProfile.h"
+
+using namespace llvm;
+using namespace std;
+
+#define DEBUG_TYPE "EdgeProfile"
+
+static cl::opt<std::string> ProfileUse("edge-profile-use", cl::init(""),
+    cl::desc("Read edge counts from this file and print block frequencies instead of instrumenting"));
+
+namespace
+{
+
+/* point on edge e where its counter is incremented, splits critical edges.
+   A block ending in unreachable leaves through a noreturn call before its
+   terminator, so its exit counter goes at the top of the block. */
+llvm::Instruction* counter_insert_point(ProfileGraph& g, ProfileEdge& e)
+{
+  if (e.dst == g.exit_node()){
+    llvm::Instruction* terminator = g.blocks[ e.src ]->getTerminator();
+    if (llvm::isa<llvm::UnreachableInst>(terminator)){
+      return &*g.blocks[ e.src ]->getFirstInsertionPt();
+    }
+    return terminator;
+  }
+  if (e.src == g.exit_node()){
+    return &*g.blocks[ e.dst ]->getFirstInsertionPt();
+  }
+
+  llvm::Instruction* terminator = g.blocks[ e.src ]->getTerminator();
+  llvm::BasicBlock* succ = terminator->getSuccessor(e.succ_index);
+  if (terminator->getNumSuccessors() == 1){
+    return terminator;
+  }
+  if (succ->getSinglePredecessor()){
+    return &*succ->getFirstInsertionPt();
+  }
+  llvm::BasicBlock* split = SplitCriticalEdge(terminator, e.succ_index);
+  return split->getTerminator();
+}
+
+/* add a counter array for F and increment it on every edge outside the
+   spanning tree. Returns the array, nullptr if F cannot be instrumented */
+llvm::GlobalVariable* instrument_function(Function &F, Module &M)
+{
+  ProfileGraph g;
+  build_profile_graph(F, g);
+  if (!g.valid){
+    errs() << "EdgeProfile: cannot place counters in " << F.getName() << ", skipped\n";
+    return nullptr;
+  }
+
+  llvm::Type* counter_type = Type::getInt64Ty(M.getContext());
+  ArrayType* array_type = ArrayType::get(counter_type, g.num_counters);
+  GlobalVariable* counters = new GlobalVariable(M, array_type, false, GlobalValue::PrivateLinkage,
+                                                ConstantAggregateZero::get(array_type),
+                                                "__edge_profile_" + F.getName());
+
+  /* splitting an edge keeps the (block, successor number) of all other edges */
+  for (auto &e : g.edges){
+    if (e.counter < 0){
+      continue;
+    }
+    IRBuilder<> Builder(counter_insert_point(g, e));
+    llvm::Value* slot = Builder.CreateConstInBoundsGEP2_32(array_type, counters, 0, e.counter);
+    llvm::Value* count = Builder.CreateLoad(counter_type, slot);
+    Builder.CreateStore(Builder.CreateAdd(count, Builder.getInt64(1)), slot);
+  }
+  return counters;
+}
+
+struct EdgeProfile : public ModulePass
+{
+  static char ID;
+  EdgeProfile() : ModulePass(ID) {}
+
+  /* read back a profile and print the frequency of every block */
+  bool print_block_frequencies(Module &M)
+  {
+    std::map<std::string, std::vector<uint64_t>> counts;
+    if (!read_edge_profile(ProfileUse, counts)){
+      errs() << "EdgeProfile: cannot read " << ProfileUse << "\n";
+      return false;
+    }
+
+    for (auto &F : M){
+      if (F.isDeclaration()){
+        continue;
+      }
+      errs() << "EdgeProfile: " << F.getName() << "\n";
+
+      DenseMap<llvm::BasicBlock*, uint64_t> freq;
+      auto found = counts.find(F.getName().str());
+      if (found == counts.end() || !compute_block_frequencies(F, found->second, freq)){
+        errs() << "no profile\n";
+        continue;
+      }
+      for (auto &basic_block : F){
+        errs() << "-----" << basic_block.getName() << "-----" << " " << freq[ &basic_block ] << "\n";
+      }
+    }
+    return false;
+  }
+
+  bool runOnModule(Module &M) override
+  {
+    if (!ProfileUse.empty()){
+      return print_block_frequencies(M);
+    }
+
+    std::vector<std::pair<Function*, GlobalVariable*>> instrumented;
+    for (auto &F : M){
+      if (F.isDeclaration()){
+        continue;
+      }
+      GlobalVariable* counters = instrument_function(F, M);
+      if (counters){
+        instrumented.push_back(std::make_pair(&F, counters));
+      }
+    }
+    if (instrumented.empty()){
+      return false;
+    }
+
+    /* constructor registering every counter array with the runtime */
+    LLVMContext &ctx = M.getContext();
+    FunctionCallee register_fn = M.getOrInsertFunction("__edge_profile_register",
+        Type::getVoidTy(ctx), Type::getInt8PtrTy(ctx), Type::getInt64PtrTy(ctx), Type::getInt32Ty(ctx));
+    Function* init = Function::Create(FunctionType::get(Type::getVoidTy(ctx), false),
+                                      GlobalValue::InternalLinkage, "__edge_profile_init", M);
+    IRBuilder<> Builder(BasicBlock::Create(ctx, "entry", init));
+    for (auto &pair : instrumented){
+      llvm::Value* name = Builder.CreateGlobalStringPtr(pair.first->getName());
+      llvm::Type* array_type = pair.second->getValueType();
+      llvm::Value* first = Builder.CreateConstInBoundsGEP2_32(array_type, pair.second, 0, 0);
+      Builder.CreateCall(register_fn, {name, first, Builder.getInt32(array_type->getArrayNumElements())});
+    }
+    Builder.CreateRetVoid();
+    appendToGlobalCtors(M, init, 0);
+
+    errs() << "EdgeProfile: instrumented " << instrumented.size() << " functions\n";
+    return true;
+  }
+}; // end of struct EdgeProfile
+} // end of anonymous namespace
+
+char EdgeProfile::ID = 0;
+static RegisterPass<EdgeProfile> X("EdgeProfile", "Edge Profiling Instrumentation Pass",
+                                      false /* Only looks at CFG */,
+                                      false /* Analysis Pass */);
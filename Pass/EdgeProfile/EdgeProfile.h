@@ -0,0 +1,229 @@
+#ifndef EDGE_PROFILE_H
+#define EDGE_PROFILE_H
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/ADT/DenseMap.h"
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <vector>
+#include <cstdint>
+
+/* Edge of the profiling graph of a function. Besides the CFG edges the
+   graph has a virtual exit node with an edge from every block that leaves
+   the function (a return, a resume, or unreachable after a noreturn call
+   such as exit()) and an edge back to the entry block, so every node conserves flow and
+   the counts of the spanning tree edges follow from the others. */
+struct ProfileEdge
+{
+  int src;
+  int dst;
+  unsigned succ_index;  /* successor number in the terminator of src, CFG edges only */
+  int counter;          /* index in the counter array, -1 for spanning tree edges */
+};
+
+/* blocks  - index to block, index blocks.size() is the virtual exit
+   edges   - every edge of the graph, in a fixed order for a given CFG
+   valid   - false if an edge that cannot be instrumented is not in the tree */
+struct ProfileGraph
+{
+  std::vector<llvm::BasicBlock*> blocks;
+  llvm::DenseMap<llvm::BasicBlock*, int> index_of;
+  std::vector<ProfileEdge> edges;
+  int num_counters = 0;
+  bool valid = true;
+
+  int exit_node() const { return blocks.size(); }
+  bool is_virtual(const ProfileEdge& e) const { return e.src == exit_node() || e.dst == exit_node(); }
+};
+
+/* a counter on the edge needs an insertion point on it; critical edges out of
+   indirect branches or into exception handling pads cannot be split */
+inline bool can_instrument_edge(ProfileGraph& g, ProfileEdge& e)
+{
+  if (g.is_virtual(e)){
+    return true;
+  }
+  llvm::Instruction* terminator = g.blocks[ e.src ]->getTerminator();
+  llvm::BasicBlock* succ = g.blocks[ e.dst ];
+  if (terminator->getNumSuccessors() == 1 || succ->getSinglePredecessor()){
+    return true;
+  }
+  return !llvm::isa<llvm::IndirectBrInst>(terminator) && !llvm::isa<llvm::CallBrInst>(terminator) &&
+         !succ->isEHPad();
+}
+
+inline int find_root(std::vector<int>& parent, int n)
+{
+  while (parent[ n ] != n){
+    parent[ n ] = parent[ parent[ n ] ];
+    n = parent[ n ];
+  }
+  return n;
+}
+
+/* Build the profiling graph and pick a spanning tree; only edges outside
+   the tree get a counter. Edges that cannot carry a counter go into the tree
+   first, then edges going backwards in the layout (most likely loop back
+   edges, the hottest ones), then the rest. The virtual edge into the entry
+   comes last so the call count is usually measured directly. */
+inline void build_profile_graph(llvm::Function &F, ProfileGraph& g)
+{
+  for (auto &basic_block : F){
+    g.index_of[ &basic_block ] = g.blocks.size();
+    g.blocks.push_back(&basic_block);
+  }
+
+  for (auto &basic_block : F){
+    int src = g.index_of[ &basic_block ];
+    llvm::Instruction* terminator = basic_block.getTerminator();
+    for (unsigned i = 0; i < terminator->getNumSuccessors(); i++){
+      g.edges.push_back(ProfileEdge{src, g.index_of[ terminator->getSuccessor(i) ], i, -1});
+    }
+    if (terminator->getNumSuccessors() == 0){
+      g.edges.push_back(ProfileEdge{src, g.exit_node(), 0, -1});
+    }
+  }
+  g.edges.push_back(ProfileEdge{g.exit_node(), g.index_of[ &F.getEntryBlock() ], 0, -1});
+
+  std::vector<std::vector<int>> order(4);
+  for (int i = 0; i < (int)g.edges.size(); i++){
+    ProfileEdge& e = g.edges[ i ];
+    if (!can_instrument_edge(g, e)){
+      order[ 0 ].push_back(i);
+    }else if (e.src == g.exit_node()){
+      order[ 3 ].push_back(i);
+    }else if (!g.is_virtual(e) && e.dst <= e.src){
+      order[ 1 ].push_back(i);
+    }else{
+      order[ 2 ].push_back(i);
+    }
+  }
+
+  std::vector<int> parent(g.blocks.size() + 1);
+  for (int n = 0; n < (int)parent.size(); n++){
+    parent[ n ] = n;
+  }
+  std::vector<bool> in_tree(g.edges.size(), false);
+  for (auto &group : order){
+    for (int i : group){
+      int a = find_root(parent, g.edges[ i ].src);
+      int b = find_root(parent, g.edges[ i ].dst);
+      if (a != b){
+        parent[ a ] = b;
+        in_tree[ i ] = true;
+      }
+    }
+  }
+
+  for (int i = 0; i < (int)g.edges.size(); i++){
+    if (!in_tree[ i ]){
+      g.edges[ i ].counter = g.num_counters++;
+      if (!can_instrument_edge(g, g.edges[ i ])){
+        g.valid = false;
+      }
+    }
+  }
+}
+
+/* Read a profile written by the runtime, one line per function and run:
+   <function name> <number of counters> <counter>...
+   Counters of the same function from several runs are summed. */
+inline bool read_edge_profile(const std::string& path, std::map<std::string, std::vector<uint64_t>>& counts)
+{
+  std::ifstream file(path);
+  if (!file){
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(file, line)){
+    std::istringstream fields(line);
+    std::string name;
+    size_t n;
+    if (!(fields >> name >> n)){
+      continue;
+    }
+    std::vector<uint64_t>& total = counts[ name ];
+    if (total.size() < n){
+      total.resize(n, 0);
+    }
+    for (size_t i = 0; i < n; i++){
+      uint64_t c = 0;
+      fields >> c;
+      total[ i ] += c;
+    }
+  }
+  return true;
+}
+
+/* Recover every edge count from the measured ones by flow conservation
+   and return the block frequencies (sum of incoming edge counts).
+   Returns false if the counters do not belong to this CFG. */
+inline bool compute_block_frequencies(llvm::Function &F, const std::vector<uint64_t>& counters,
+                                      llvm::DenseMap<llvm::BasicBlock*, uint64_t>& freq)
+{
+  ProfileGraph g;
+  build_profile_graph(F, g);
+  if ((int)counters.size() != g.num_counters){
+    return false;
+  }
+
+  std::vector<int64_t> count(g.edges.size(), 0);
+  std::vector<bool> known(g.edges.size(), false);
+  for (int i = 0; i < (int)g.edges.size(); i++){
+    if (g.edges[ i ].counter >= 0){
+      count[ i ] = counters[ g.edges[ i ].counter ];
+      known[ i ] = true;
+    }
+  }
+
+  std::vector<std::vector<int>> incident(g.exit_node() + 1);
+  for (int i = 0; i < (int)g.edges.size(); i++){
+    incident[ g.edges[ i ].src ].push_back(i);
+    if (g.edges[ i ].dst != g.edges[ i ].src){
+      incident[ g.edges[ i ].dst ].push_back(i);
+    }
+  }
+
+  /* a node with a single unknown incident edge determines that edge */
+  bool changed = true;
+  while (changed){
+    changed = false;
+    for (int node = 0; node <= g.exit_node(); node++){
+      int64_t in = 0, out = 0;
+      int unknown = -1, num_unknown = 0;
+      for (int i : incident[ node ]){
+        ProfileEdge& e = g.edges[ i ];
+        if (!known[ i ]){
+          unknown = i;
+          num_unknown++;
+          continue;
+        }
+        if (e.dst == node) in += count[ i ];
+        if (e.src == node) out += count[ i ];
+      }
+      if (num_unknown == 1){
+        count[ unknown ] = g.edges[ unknown ].dst == node ? out - in : in - out;
+        known[ unknown ] = true;
+        changed = true;
+      }
+    }
+  }
+
+  for (auto *bb : g.blocks){
+    freq[ bb ] = 0;
+  }
+  for (int i = 0; i < (int)g.edges.size(); i++){
+    if (g.edges[ i ].dst != g.exit_node() && count[ i ] > 0){
+      freq[ g.blocks[ g.edges[ i ].dst ] ] += count[ i ];
+    }
+  }
+  return true;
+}
+
+#endif
@@ -0,0 +1,56 @@
+/* Runtime of the EdgeProfile instrumentation. Instrumented modules register
+   the counter array of every function from a global constructor; the counts
+   are appended to $EDGE_PROFILE_FILE (default edge_profile.txt) at exit,
+   one line per function: <name> <number of counters> <counter>... */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+struct edge_profile_function
+{
+  const char* name;
+  uint64_t* counters;
+  uint32_t num_counters;
+  struct edge_profile_function* next;
+};
+
+static struct edge_profile_function* registered = NULL;
+
+static void edge_profile_dump(void)
+{
+  const char* path = getenv("EDGE_PROFILE_FILE");
+  if (path == NULL){
+    path = "edge_profile.txt";
+  }
+  FILE* file = fopen(path, "a");
+  if (file == NULL){
+    perror(path);
+    return;
+  }
+
+  for (struct edge_profile_function* f = registered; f != NULL; f = f->next){
+    fprintf(file, "%s %" PRIu32, f->name, f->num_counters);
+    for (uint32_t i = 0; i < f->num_counters; i++){
+      fprintf(file, " %" PRIu64, f->counters[ i ]);
+    }
+    fprintf(file, "\n");
+  }
+  fclose(file);
+}
+
+void __edge_profile_register(const char* name, uint64_t* counters, uint32_t num_counters)
+{
+  struct edge_profile_function* f = malloc(sizeof(struct edge_profile_function));
+  if (f == NULL){
+    return;
+  }
+  if (registered == NULL){
+    atexit(edge_profile_dump);
+  }
+  f->name = name;
+  f->counters = counters;
+  f->num_counters = num_counters;
+  f->next = registered;
+  registered = f;
+}
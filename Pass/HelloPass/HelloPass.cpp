@@ -2,86 +2,254 @@
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Function.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Format.h"
 #include "llvm/IR/Type.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/CFG.h"
+#include "llvm/Analysis/CFG.h"
 
 #include <string>
+#include <vector>
 
 using namespace llvm;
 using namespace std;
 
 #define DEBUG_TYPE "HelloPass"
 
+static cl::opt<bool> JsonOutput("hello-json", cl::init(false),
+    cl::desc("Print the IR statistics as JSON instead of a table"));
+
 namespace
 {
+  /* histogram buckets: fan-in/fan-out 0..7 and 8+,
+     block sizes by power of two 1, 2-3, 4-7, ..., 256+ */
+  const unsigned NUM_BUCKETS = 9;
+
+  /* flat counters of one function, or of the whole module */
+  struct IRStats
+  {
+    std::string name;
+    uint64_t blocks = 0;
+    uint64_t instructions = 0;
+    uint64_t edges = 0;
+    uint64_t critical_edges = 0;
+    uint64_t opcodes[Instruction::OtherOpsEnd] = {};
+    uint64_t block_size[NUM_BUCKETS] = {};
+    uint64_t fan_in[NUM_BUCKETS] = {};
+    uint64_t fan_out[NUM_BUCKETS] = {};
+
+    void add(const IRStats &other)
+    {
+      blocks += other.blocks;
+      instructions += other.instructions;
+      edges += other.edges;
+      critical_edges += other.critical_edges;
+      for (unsigned i = 0; i < Instruction::OtherOpsEnd; i++)
+        opcodes[i] += other.opcodes[i];
+      for (unsigned i = 0; i < NUM_BUCKETS; i++)
+      {
+        block_size[i] += other.block_size[i];
+        fan_in[i] += other.fan_in[i];
+        fan_out[i] += other.fan_out[i];
+      }
+    }
+  };
+
+  unsigned count_bucket(unsigned n)
+  {
+    return n < NUM_BUCKETS - 1 ? n : NUM_BUCKETS - 1;
+  }
+
+  unsigned size_bucket(unsigned n)
+  {
+    unsigned log = n == 0 ? 0 : Log2_32(n);
+    return log < NUM_BUCKETS - 1 ? log : NUM_BUCKETS - 1;
+  }
+
+  std::string count_label(unsigned bucket)
+  {
+    return bucket == NUM_BUCKETS - 1 ? to_string(bucket) + "+" : to_string(bucket);
+  }
+
+  std::string size_label(unsigned bucket)
+  {
+    unsigned low = 1u << bucket;
+    if (bucket == NUM_BUCKETS - 1)
+      return to_string(low) + "+";
+    if (low == 1)
+      return "1";
+    return to_string(low) + "-" + to_string(2 * low - 1);
+  }
+
+  void print_json_string(raw_ostream &os, StringRef s)
+  {
+    os << '"';
+    for (char c : s)
+    {
+      if (c == '"' || c == '\\')
+        os << '\\' << c;
+      else if ((unsigned char)c < 0x20)
+        os << format("\\u%04x", c);
+      else
+        os << c;
+    }
+    os << '"';
+  }
+
+  void print_json_histogram(raw_ostream &os, const uint64_t *hist, bool sizes)
+  {
+    os << "{";
+    bool first = true;
+    for (unsigned i = 0; i < NUM_BUCKETS; i++)
+    {
+      if (hist[i] == 0)
+        continue;
+      os << (first ? "" : ", ");
+      print_json_string(os, sizes ? size_label(i) : count_label(i));
+      os << ": " << hist[i];
+      first = false;
+    }
+    os << "}";
+  }
+
+  void print_json(raw_ostream &os, const IRStats &stats, const char *indent)
+  {
+    os << indent << "{\"name\": ";
+    print_json_string(os, stats.name);
+    os << ", \"blocks\": " << stats.blocks
+       << ", \"instructions\": " << stats.instructions
+       << ", \"edges\": " << stats.edges
+       << ", \"critical_edges\": " << stats.critical_edges << ",\n";
+
+    os << indent << " \"opcodes\": {";
+    bool first = true;
+    for (unsigned i = 0; i < Instruction::OtherOpsEnd; i++)
+    {
+      if (stats.opcodes[i] == 0)
+        continue;
+      os << (first ? "" : ", ") << "\"" << Instruction::getOpcodeName(i) << "\": " << stats.opcodes[i];
+      first = false;
+    }
+    os << "},\n";
+
+    os << indent << " \"block_size\": ";
+    print_json_histogram(os, stats.block_size, true);
+    os << ", \"fan_in\": ";
+    print_json_histogram(os, stats.fan_in, false);
+    os << ", \"fan_out\": ";
+    print_json_histogram(os, stats.fan_out, false);
+    os << "}";
+  }
+
+  void print_table_histogram(raw_ostream &os, const char *title, const uint64_t *hist, bool sizes)
+  {
+    os << "  " << left_justify(title, 12);
+    for (unsigned i = 0; i < NUM_BUCKETS; i++)
+    {
+      if (hist[i] != 0)
+        os << " " << (sizes ? size_label(i) : count_label(i)) << ":" << hist[i];
+    }
+    os << "\n";
+  }
+
+  void print_table(raw_ostream &os, const IRStats &stats)
+  {
+    os << stats.name << ": blocks " << stats.blocks
+       << ", instructions " << stats.instructions
+       << ", edges " << stats.edges
+       << ", critical edges " << stats.critical_edges << "\n";
+
+    os << "  " << left_justify("opcodes", 12);
+    for (unsigned i = 0; i < Instruction::OtherOpsEnd; i++)
+    {
+      if (stats.opcodes[i] != 0)
+        os << " " << Instruction::getOpcodeName(i) << ":" << stats.opcodes[i];
+    }
+    os << "\n";
+    print_table_histogram(os, "block size", stats.block_size, true);
+    print_table_histogram(os, "fan-in", stats.fan_in, false);
+    print_table_histogram(os, "fan-out", stats.fan_out, false);
+  }
+
   struct HelloPass : public FunctionPass
   {
     static char ID;
     HelloPass() : FunctionPass(ID) {}
 
+    /* one entry per analysed function, printed together at the end */
+    std::vector<IRStats> function_stats;
+
     bool runOnFunction(Function &F) override
     {
-      errs() << "HelloPass runOnFunction: ";
-      errs() << F.getName() << "\n";
+      IRStats stats;
+      stats.name = F.getName().str();
 
       for (auto &basic_block : F)
       {
         /* Caluclate the predecessors and sucessors for each basic block */
-        int predecessors = std::distance(pred_begin(&basic_block), pred_end(&basic_block));
-        int successors = std::distance(succ_begin(&basic_block), succ_end(&basic_block));
-
-        /* print them for each basic block*/
-        errs() << "Number of Predecessors: " << predecessors << "\n";
-        errs() << "Number of Successors: " << successors << "\n";
+        unsigned predecessors = pred_size(&basic_block);
+        unsigned successors = succ_size(&basic_block);
+        unsigned size = 0;
 
         for (auto &inst : basic_block)
         {
-          errs() << inst << "\n";
-          if (inst.getOpcode() == Instruction::Load)
-          {
-            errs() << "This is Load"
-                   << "\n";
-          }
-          if (inst.getOpcode() == Instruction::Store)
-          {
-            errs() << "This is Store"
-                   << "\n";
-          }
-          if (inst.isBinaryOp())
+          stats.opcodes[inst.getOpcode()]++;
+          size++;
+        }
+
+        const Instruction *terminator = basic_block.getTerminator();
+        if (terminator)
+        {
+          for (unsigned i = 0; i < successors; i++)
           {
-            errs() << "Op Code:" << inst.getOpcodeName() << "\n"; 
-            if (inst.getOpcode() == Instruction::Add)
-            {
-              errs() << "This is Addition"
-                     << "\n";
-            }
-            if (inst.getOpcode() == Instruction::Sub)
-            {
-              errs() << "This is Subtraction"
-                     << "\n";
-            }
-            if (inst.getOpcode() == Instruction::Mul)
-            {
-              errs() << "This is Multiplication"
-                     << "\n";
-            }
-            if (inst.getOpcode() == Instruction::SDiv)
-            {
-              errs() << "This is Division"
-                     << "\n";
-            }
-
-            // See Other classes, Instruction::Sub, Instruction::UDiv, Instruction::SDiv
-            auto *ptr = dyn_cast<User>(&inst);
-            for (auto it = ptr->op_begin(); it != ptr->op_end(); ++it)
-            {
-              errs() << "\t" << *(*it) << "\n";
-            }
+            if (isCriticalEdge(terminator, i))
+              stats.critical_edges++;
           }
         }
+
+        stats.blocks++;
+        stats.instructions += size;
+        stats.edges += successors;
+        stats.block_size[size_bucket(size)]++;
+        stats.fan_in[count_bucket(predecessors)]++;
+        stats.fan_out[count_bucket(successors)]++;
       }
+
+      function_stats.push_back(stats);
+      return false;
+    }
+
+    bool doFinalization(Module &M) override
+    {
+      IRStats total;
+      total.name = "module";
+      for (auto &stats : function_stats)
+        total.add(stats);
+
+      raw_ostream &os = errs();
+      if (JsonOutput)
+      {
+        os << "{\"module\":\n";
+        print_json(os, total, "  ");
+        os << ",\n \"functions\": [\n";
+        for (unsigned i = 0; i < function_stats.size(); i++)
+        {
+          print_json(os, function_stats[i], "  ");
+          os << (i + 1 < function_stats.size() ? ",\n" : "\n");
+        }
+        os << " ]}\n";
+      }
+      else
+      {
+        for (auto &stats : function_stats)
+          print_table(os, stats);
+        print_table(os, total);
+      }
+
+      function_stats.clear();
       return false;
     }
   }; // end of Hello pass
@@ -90,4 +258,4 @@ namespace
 char HelloPass::ID = 0;
 static RegisterPass<HelloPass> X("Hello", "Hello Pass",
                                  false /* Only looks at CFG */,
-                                 false /* Analysis Pass */);
\ No newline at end of file
+                                 false /* Analysis Pass */);
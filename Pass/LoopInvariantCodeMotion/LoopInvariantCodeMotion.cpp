@@ -0,0 +1,134 @@
+#include "llvm/Pass.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/IR/Type.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include <string>
+#include <vector>
+
+#include "ReachingDefinition/ReachingDefinition.h"
+
+using namespace llvm;
+using namespace std;
+
+#define DEBUG_TYPE "LoopInvariantCodeMotion"
+
+namespace
+{
+
+/* an operand is invariant if it is computed outside the loop
+   or by an instruction that was already found to be invariant */
+bool is_invariant_operand(llvm::Value* op, Loop* loop, SmallPtrSetImpl<llvm::Instruction*>& invariant)
+{
+  llvm::Instruction* def = dyn_cast<Instruction>(op);
+  return def == nullptr || !loop->contains(def) || invariant.count(def);
+}
+
+/* a load is invariant if no definition of the variable inside the loop reaches it */
+bool is_invariant_load(llvm::LoadInst* load, Loop* loop, ReachingDefinitionInfo& info)
+{
+  if (load->isVolatile() || !is_tracked_var(load->getPointerOperand())){
+    return false;
+  }
+  for (int d : defs_reaching_load(load, info)){
+    if (loop->contains(info.numbering[ d ])){
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Hoist invariant binary operators and loads of one loop into its preheader.
+   Returns the number of instructions moved. */
+int hoist_loop_invariants(Loop* loop, ReachingDefinitionInfo& info)
+{
+  llvm::BasicBlock* preheader = loop->getLoopPreheader();
+  if (preheader == nullptr){
+    return 0;
+  }
+
+  /* repeat until nothing new is found, an operand may sit in a later block than its user */
+  SmallPtrSet<llvm::Instruction*, 32> invariant;
+  std::vector<llvm::Instruction*> hoist;
+  bool changed = true;
+  while (changed){
+    changed = false;
+    for (auto *basic_block : loop->getBlocks()){
+      for (auto &inst : *basic_block){
+        if (invariant.count(&inst)){
+          continue;
+        }
+
+        bool is_inv = false;
+        if (LoadInst* load_instruction = dyn_cast<LoadInst>(&inst)){
+          is_inv = is_invariant_load(load_instruction, loop, info);
+        }else if (inst.isBinaryOp() && isSafeToSpeculativelyExecute(&inst)){
+          is_inv = is_invariant_operand(inst.getOperand(0), loop, invariant) &&
+                   is_invariant_operand(inst.getOperand(1), loop, invariant);
+        }
+
+        if (is_inv){
+          invariant.insert(&inst);
+          hoist.push_back(&inst);
+          changed = true;
+        }
+      }
+    }
+  }
+
+  /* hoist keeps the order in which operands became invariant */
+  for (auto *inst : hoist){
+    inst->moveBefore(preheader->getTerminator());
+  }
+  return hoist.size();
+}
+
+struct LoopInvariantCodeMotion : public FunctionPass
+{
+  static char ID;
+  LoopInvariantCodeMotion() : FunctionPass(ID) {}
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override
+  {
+    AU.addRequired<LoopInfoWrapperPass>();
+    AU.setPreservesCFG();
+  }
+
+  bool runOnFunction(Function &F) override
+  {
+    errs() << "LoopInvariantCodeMotion: ";
+    errs() << F.getName() << "\n";
+
+    LoopInfo &LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+
+    /* stores are never moved, so the reaching definitions stay valid while hoisting */
+    ReachingDefinitionInfo info;
+    compute_reaching_definitions(F, info);
+
+    /* inner loops first, what they hoist may be invariant in the outer loop too */
+    int hoisted = 0;
+    SmallVector<Loop*, 8> loops = LI.getLoopsInPreorder();
+    for (auto it = loops.rbegin(); it != loops.rend(); ++it){
+      int n = hoist_loop_invariants(*it, info);
+      if (n != 0){
+        errs() << "Loop " << (*it)->getHeader()->getName() << ": hoisted " << n << "\n";
+      }
+      hoisted += n;
+    }
+
+    errs() << "Instructions hoisted: " << hoisted << "\n";
+    return hoisted != 0;
+  }
+}; // end of struct LoopInvariantCodeMotion
+} // end of anonymous namespace
+
+char LoopInvariantCodeMotion::ID = 0;
+static RegisterPass<LoopInvariantCodeMotion> X("LoopInvariantCodeMotion", "Loop Invariant Code Motion Pass",
+                                      false /* Only looks at CFG */,
+                                      false /* Analysis Pass */);
@@ -8,69 +8,158 @@
 #include "llvm/IR/CFG.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
 #include <string>
 #include <fstream>
 #include <unordered_map>
+#include <map>
 #include <set>
 #include <queue>
+#include <vector>
+
+#include "ReachingDefinition/ReachingDefinition.h"
 
 using namespace llvm;
 using namespace std;
 
 #define DEBUG_TYPE "ReachingDefinition"
 
-void print_set(std::set<int>& st, std::string type){
-  errs() << type << ": ";
-  for (auto &i : st){
-    errs() << i << " ";
+STATISTIC(NumApproximated, "Functions whose reaching definitions were approximated");
+STATISTIC(NumReachingEntry, "Definitions reaching a block entry, summed over blocks");
+STATISTIC(NumCacheHits, "Functions whose result came from the cache");
+STATISTIC(NumCacheMisses, "Functions computed and written to the cache");
+
+static cl::opt<unsigned> MaxBlocks("rd-max-blocks", cl::init(0),
+    cl::desc("Approximate functions with more blocks than this (0 = no limit)"));
+static cl::opt<unsigned> MaxDefs("rd-max-defs", cl::init(0),
+    cl::desc("Approximate functions with more definitions than this (0 = no limit)"));
+static cl::opt<unsigned> MaxIterations("rd-max-iterations", cl::init(0),
+    cl::desc("Approximate if IN/OUT need more sweeps than this (0 = no limit)"));
+static cl::opt<double> MaxTime("rd-max-time", cl::init(0),
+    cl::desc("Approximate if a function takes longer than this many seconds (0 = no limit)"));
+static cl::opt<std::string> Sets("rd-sets", cl::init("auto"),
+    cl::desc("Form of the definition sets: auto, dense or sparse"));
+static cl::opt<bool> StableIds("rd-stable-ids", cl::init(false),
+    cl::desc("Name definitions function:block.instruction and end each function with a digest"));
+static cl::opt<std::string> CacheDir("rd-cache-dir", cl::init(""),
+    cl::desc("Reuse results stored in this directory for functions whose IR did not change"));
+static cl::opt<std::string> Kernels("rd-kernels", cl::init(""),
+    cl::desc("Bit set kernels to use: scalar, sse2 or avx2 (default: best the CPU supports)"));
+
+/* How definitions and blocks are named in the output: by running index and
+   block name, or with -rd-stable-ids by function:block ordinal.instruction
+   ordinal, which only changes when that block changes */
+struct OutputNames
+{
+  bool stable;
+  StringRef function;
+  InstructionNumbering& numbering;
+  DenseMap<const BasicBlock*, unsigned> block_ordinal;
+  std::vector<const BasicBlock*> block_of;
+
+  OutputNames(bool stable, Function& F, InstructionNumbering& numbering)
+    : stable(stable), function(F.getName()), numbering(numbering)
+  {
+    unsigned ordinal = 0;
+    for (auto &basic_block : F){
+      block_ordinal[ &basic_block ] = ordinal++;
+      for (unsigned ind = numbering.block_begin(&basic_block); ind < numbering.block_end(&basic_block); ind++){
+        block_of.push_back(&basic_block);
+      }
+    }
   }
-  errs() << "\n";
+
+  void print_def(raw_ostream& os, unsigned ind)
+  {
+    if (!stable){
+      os << ind;
+      return;
+    }
+    const BasicBlock* bb = block_of[ ind ];
+    os << function << ":" << block_ordinal[ bb ] << "." << ind - numbering.block_begin(bb);
+  }
+
+  void print_block(raw_ostream& os, BasicBlock& basic_block)
+  {
+    os << "-----";
+    if (stable){
+      os << function << ":" << block_ordinal[ &basic_block ];
+      if (basic_block.hasName()){
+        os << " ";
+      }
+    }
+    os << basic_block.getName() << "-----" << "\n";
+  }
+};
+
+void print_set(raw_ostream& os, OutputNames& names, const DefSet& st, std::string type){
+  os << type << ": ";
+  for (int i : st){
+    names.print_def(os, i);
+    os << " ";
+  }
+  os << "\n";
 }
 
-void print_instruction_blocks_with_index(std::map<int , llvm::Instruction*>& all_ins, Function& F)
+void print_instruction_blocks_with_index(raw_ostream& os, OutputNames& names, InstructionNumbering& numbering, Function& F)
 {
     for (auto &basic_block : F)
     {
-      errs() << "-----" << basic_block.getName() << "-----" << "\n";
-
-      for (auto &i : all_ins){
-        llvm::Instruction* inst = i.second;
-        int ind = i.first;
-        
-        /* Print instructions belonging to this block */
-        if (inst->getParent() == &basic_block){
-          errs() << ind << ":" << *inst << "\n";
-        } 
+      names.print_block(os, basic_block);
+
+      /* Print instructions belonging to this block */
+      for (unsigned ind = numbering.block_begin(&basic_block); ind < numbering.block_end(&basic_block); ind++){
+        names.print_def(os, ind);
+        os << ":" << *numbering[ ind ] << "\n";
       }
     }
 }
 
-set<int> union_of_pred(BasicBlock *bb, map<BasicBlock* , set<int>>& OUT)
+/* Cache file of a function: the MD5 of its IR and of every option that
+   changes the output. A hit is the exact text printed when it was computed.
+   Only exact results are written, so a hit never carries an approximation. */
+void cache_path(Function& F, SmallVectorImpl<char>& path)
 {
-  std::set<int> result;
-
-  /* get the predecessors */
-  for (auto PI = pred_begin(bb), E = pred_end(bb); PI != E; ++PI)
-  {
-    BasicBlock *pred = *PI; 
-    set<int> out = OUT[pred]; 
-    std::set_union(result.begin(), result.end(), out.begin(), out.end(), std::inserter(result, result.begin()));
-
-  }
-
-  return result; 
+  SmallString<4096> ir;
+  raw_svector_ostream ir_stream(ir);
+  ir_stream << "rd-cache-v1 " << StableIds << " " << MaxBlocks << " " << MaxDefs << " "
+            << MaxIterations << " " << MaxTime << "\n";
+  F.print(ir_stream);
+
+  MD5 hash;
+  hash.update(ir.str());
+  MD5::MD5Result digest;
+  hash.final(digest);
+
+  path.clear();
+  sys::path::append(path, CacheDir.getValue(), digest.digest().str() + ".rd");
 }
 
-set<int> getOutSet(const std::set<int>& gen, const std::set<int>& in, const std::set<int>& kill)
+/* write through a unique temporary renamed into place, so a concurrent
+   reader never sees a partial file */
+void write_cache(StringRef path, StringRef contents)
 {
-  std::set<int> resultset; 
-  std::set<int> temp; 
-
-  std::set_difference(in.begin(), in.end(), kill.begin() , kill.end(), std::inserter(temp, temp.begin()));
-  std::set_union(gen.begin(), gen.end(), temp.begin(), temp.end(), std::inserter(resultset, resultset.begin()));
-
-  return resultset;
-  
+  if (sys::fs::create_directories(CacheDir.getValue())){
+    return;
+  }
+  int fd;
+  SmallString<256> temp;
+  if (sys::fs::createUniqueFile(path + ".tmp%%%%%%", fd, temp)){
+    return;
+  }
+  {
+    raw_fd_ostream out(fd, true);
+    out << contents;
+  }
+  if (sys::fs::rename(temp, path)){
+    sys::fs::remove(temp);
+  }
 }
 
 namespace
@@ -86,144 +175,86 @@ struct ReachingDefinition : public FunctionPass
     errs() << "ReachingDefinition: By Anvaya and Arnav : Compiler Construction Phase-II: ";
     errs() << F.getName() << "\n";
 
-    /* Retrive Information of the instruction from the IR */
-
-    /* Data Structures to hold the data 
-      all_ins - map of index to instruction 
-      def_of_var - map between varname 
-                  (string) and vector of all the indexes var is defined 
-      latest_defs_in_block - map of Block to (map <string to index>)                   
-    */
-    std::map<int, llvm::Instruction*> all_ins; 
-    std::map<llvm::BasicBlock*, std::map<std::string, int>> latest_def_in_block;
-
-    /* Index */
-    int i = 0 ; 
-
-    for (auto &basic_block : F)
-    { 
-
-      std::map<std::string, int> l_def; 
-      std:: map<std::string, std::set<int>> def_of_var;
-      for (auto &inst : basic_block)
-      {
-        /* add each instruction to all_ins */
-        all_ins[ i ] = &inst;
-
-        /* If instruction is store operation */
-        if (inst.getOpcode() == Instruction::Store){
-
-          StoreInst *store_instruction = dyn_cast<StoreInst>(&inst); 
-          if (store_instruction){
-              
-              /* add to def_of_var */
-              if (store_instruction->getPointerOperand() -> hasName()){
-                std::string var_name = store_instruction->getPointerOperand() ->getName().str();
-                l_def [var_name] = i ;
-              }
-          }
-        }
-        i++;
+    /* a cached result is mapped and printed, the dataflow is not solved */
+    SmallString<256> cached;
+    if (!CacheDir.empty()){
+      cache_path(F, cached);
+      ErrorOr<std::unique_ptr<MemoryBuffer>> hit = MemoryBuffer::getFile(cached, false, false);
+      if (hit){
+        errs() << (*hit)->getBuffer();
+        NumCacheHits++;
+        return false;
       }
+    }
 
-      /* add to global latest def */
-      latest_def_in_block [&basic_block] = l_def; 
+    /* Retrive Information of the instruction from the IR and
+       compute GEN, KILL, IN, OUT sets (see ReachingDefinition.h) */
+    if (!Kernels.empty() && !select_bitset_kernels(Kernels.c_str())){
+      errs() << "Kernels " << Kernels << " not supported, using " << bitset_kernels().name << "\n";
+    }
 
+    AnalysisBudget budget;
+    budget.max_blocks = MaxBlocks;
+    budget.max_items = MaxDefs;
+    budget.max_iterations = MaxIterations;
+    budget.max_seconds = MaxTime;
+
+    ReachingDefinitionInfo info;
+    if (Sets == "dense"){
+      info.representation = DENSE_SETS;
+    }else if (Sets == "sparse"){
+      info.representation = SPARSE_SETS;
+    }
+    compute_reaching_definitions(F, info, budget);
+
+    /* stable and cached output is collected first, to end it with a digest
+       of the function or to store it */
+    bool buffered = StableIds || !CacheDir.empty();
+    OutputNames names(StableIds, F, info.numbering);
+    SmallString<4096> buffer;
+    raw_svector_ostream buffer_stream(buffer);
+    raw_ostream& os = buffered ? (raw_ostream&)buffer_stream : errs();
+
+    if (!info.exceeded.empty()){
+      os << "Budget exceeded (" << info.exceeded << "), every definition assumed to reach every block\n";
+      NumApproximated++;
     }
 
     /* Print the instrctions with its index and  */
     //DEBUG Print 
-    print_instruction_blocks_with_index(all_ins, F);
+    print_instruction_blocks_with_index(os, names, info.numbering, F);
 
-    /* Global GEN, KILL , IN, OUT sets*/
-    std::map<llvm::BasicBlock*, set<int>> IN; 
-    std::map<llvm::BasicBlock*, set<int>> OUT; 
-    std::map<llvm::BasicBlock*, set<int>> GEN; 
-    std::map<llvm::BasicBlock*, set<int>> KILL; 
-
-    /* reinitialise the index */
-    i = 0 ; 
-    for (auto &basic_block : F)
-    {
-      /* kill gen set for each block */
-      std::set<int> gen; 
-      std::set<int> kill; 
-      std::set<int> in;
-      std::set<int> out;
-      
-      std::map<std::string, int> temp_ldef = latest_def_in_block [ &basic_block ]; 
-
-      /* Gen Set : definitions within Basic Block (B) that reach the end of B 
-
-      */
-      for (auto &inst : basic_block)
-      {
-
-        /* create Gen Set for store operations */
-        if (inst.getOpcode() == Instruction::Store){
-
-          StoreInst *store_instruction = dyn_cast<StoreInst>(&inst); 
-          if (store_instruction){
-            if (store_instruction->getPointerOperand() -> hasName()){
-                std::string var_name = store_instruction->getPointerOperand() ->getName().str();
-                
-                /* Only add definitions that reach */
-                if(temp_ldef.find(var_name) != temp_ldef.end()){
-                  gen.insert(temp_ldef[var_name]); 
-
-                  /* if the index of the varname is different add to kill set */
-                  if (i != temp_ldef[var_name]){
-                    kill.insert(i); 
-                  }
-                } 
-
-                /* Other additions to Kill Set */
-                /* what are all the defintions found in the predecessors */
-                for (auto PI = pred_begin(&basic_block), E = pred_end(&basic_block); PI != E; ++PI) {
-                    BasicBlock *Pred = *PI;
-                    std::map<std::string, int> temp_prev_ldef =  latest_def_in_block [ Pred ]; 
-
-                    if ((temp_prev_ldef.find(var_name) != temp_prev_ldef.end()) &&
-                         (gen.find(temp_ldef[var_name]) != gen.end())){
-
-                          kill.insert(temp_prev_ldef[var_name]); 
-                    }
-                }
-            }    
-
-          }
-
-        }
-        i++; 
-      }
-      /* add to global set */
-      GEN [ &basic_block ] = gen; 
-      KILL [ &basic_block ] = kill;
-    }    
-
-    /* compute and print Reaching definition sets */
-    /* reinitialise the index */
-    i = 0 ; 
+    /* print Reaching definition sets */
     for (auto &basic_block : F){
 
-      /* if entry block IN[B] = null */
-      if (basic_block.getName() == "entry"){
-        std::set<int> nullset; 
-        IN [ &basic_block ] = nullset; 
-      }else{
-        IN [ &basic_block ] = union_of_pred(&basic_block, OUT); 
-      }
-
-      OUT[ &basic_block ] = getOutSet(GEN [&basic_block], IN[ &basic_block ], KILL[ &basic_block]); 
-
       /* Print to Console or whatever */
-      errs() << "-----" << basic_block.getName() << "-----" << "\n";
+      names.print_block(os, basic_block);
+
+      print_set(os, names, info.GEN[&basic_block], "GEN");
+      print_set(os, names, info.KILL[&basic_block], "KILL");
+      print_set(os, names, info.IN[&basic_block], "IN");
+      print_set(os, names, info.OUT[ &basic_block], "OUT");
+      NumReachingEntry += info.IN[ &basic_block ].count();
 
-      print_set(GEN[&basic_block], "GEN");
-      print_set(KILL[&basic_block], "KILL");
-      print_set(IN[&basic_block], "IN");
-      print_set(OUT[ &basic_block], "OUT");
+    }
 
+    if (StableIds){
+      MD5 hash;
+      hash.update(buffer.str());
+      MD5::MD5Result digest;
+      hash.final(digest);
+      os << "Digest: " << digest.digest() << "\n";
+    }
+    /* an approximated result depends on the time limit and the machine,
+       only exact results are kept */
+    if (!CacheDir.empty()){
+      if (info.exceeded.empty()){
+        write_cache(cached, buffer);
+      }
+      NumCacheMisses++;
+    }
+    if (buffered){
+      errs() << buffer;
     }
 
     return true;
@@ -0,0 +1,453 @@
+#ifndef REACHING_DEFINITION_H
+#define REACHING_DEFINITION_H
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/Transforms/Utils/PromoteMemToReg.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/SparseBitVector.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/MathExtras.h"
+#include "Common/InstructionNumbering.h"
+#include "Common/BitSetKernels.h"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+/* Compile time limits of an analysis, 0 means no limit. items is what
+   the analysis grows with: definitions for reaching definitions,
+   instructions for CSE. The clock starts when the budget is created. */
+struct AnalysisBudget
+{
+  unsigned max_blocks = 0;
+  unsigned max_items = 0;
+  unsigned max_iterations = 0;
+  double max_seconds = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  bool out_of_time() const
+  {
+    std::chrono::duration<double> spent = std::chrono::steady_clock::now() - start;
+    return max_seconds > 0 && spent.count() > max_seconds;
+  }
+
+  /* name of the first limit that is exceeded, empty if none */
+  std::string exceeded(unsigned blocks, unsigned items, unsigned iterations) const
+  {
+    if (max_blocks && blocks > max_blocks){
+      return "blocks";
+    }
+    if (max_items && items > max_items){
+      return "size";
+    }
+    if (max_iterations && iterations > max_iterations){
+      return "iterations";
+    }
+    if (out_of_time()){
+      return "time";
+    }
+    return "";
+  }
+};
+
+/* Set of definition indexes below a fixed size, in one of two forms:
+   dense  - a bit vector whose words live in the arena of the
+            ReachingDefinitionInfo that made the set; whole-set operations
+            run on the vectorised kernels of BitSetKernels.h
+   sparse - an llvm::SparseBitVector, a sorted list of 128 bit chunks
+            holding only the non-empty parts, also owned by that info
+   Both forms have the same operations, but the operands of one operation
+   must share a form (all sets of one info do). A DefSet is only a view:
+   copying it shares the bits, use copy_from to copy the contents. */
+class DefSet
+{
+public:
+  typedef uint64_t Word;
+  typedef llvm::SparseBitVector<128> Sparse;
+  static const unsigned WORD_BITS = 64;
+
+  DefSet() {}
+  DefSet(llvm::BumpPtrAllocator& arena, unsigned size)
+    : num_bits(size), num_words((size + WORD_BITS - 1) / WORD_BITS)
+  {
+    words = arena.Allocate<Word>(num_words);
+    clear();
+  }
+  DefSet(Sparse* sparse, unsigned size) : sparse(sparse), num_bits(size) {}
+
+  unsigned size() const { return num_bits; }
+  bool is_sparse() const { return sparse != nullptr; }
+
+  bool test(unsigned i) const
+  {
+    if (sparse){
+      return sparse->test(i);
+    }
+    return (words[ i / WORD_BITS ] >> (i % WORD_BITS)) & 1;
+  }
+
+  void set(unsigned i)
+  {
+    if (sparse){
+      sparse->set(i);
+    }else{
+      words[ i / WORD_BITS ] |= Word(1) << (i % WORD_BITS);
+    }
+  }
+
+  void clear()
+  {
+    if (sparse){
+      sparse->clear();
+    }else{
+      std::fill(words, words + num_words, 0);
+    }
+  }
+
+  void copy_from(const DefSet& other)
+  {
+    if (sparse){
+      *sparse = *other.sparse;
+    }else{
+      std::copy(other.words, other.words + num_words, words);
+    }
+  }
+
+  void union_with(const DefSet& other)
+  {
+    if (sparse){
+      *sparse |= *other.sparse;
+    }else{
+      bitset_kernels().union_with(words, other.words, num_words);
+    }
+  }
+
+  void subtract(const DefSet& other)
+  {
+    if (sparse){
+      sparse->intersectWithComplement(*other.sparse);
+    }else{
+      bitset_kernels().subtract(words, other.words, num_words);
+    }
+  }
+
+  /* this = gen | (in & ~kill) */
+  void transfer(const DefSet& gen, const DefSet& in, const DefSet& kill)
+  {
+    if (sparse){
+      sparse->intersectWithComplement(*in.sparse, *kill.sparse);
+      *sparse |= *gen.sparse;
+    }else{
+      bitset_kernels().transfer(words, gen.words, in.words, kill.words, num_words);
+    }
+  }
+
+  bool equals(const DefSet& other) const
+  {
+    if (sparse){
+      return *sparse == *other.sparse;
+    }
+    return bitset_kernels().equals(words, other.words, num_words);
+  }
+
+  unsigned count() const
+  {
+    if (sparse){
+      return sparse->count();
+    }
+    return bitset_kernels().count(words, num_words);
+  }
+
+  /* members in increasing order */
+  class iterator
+  {
+  public:
+    iterator(const DefSet* set, int current) : set(set), current(current) {}
+    iterator(const DefSet* set, Sparse::iterator sparse_it) : set(set), current(0), sparse_it(sparse_it) {}
+    int operator*() const { return set->sparse ? (int)*sparse_it : current; }
+    iterator& operator++()
+    {
+      if (set->sparse){
+        ++sparse_it;
+      }else{
+        current = set->find_next(current);
+      }
+      return *this;
+    }
+    bool operator!=(const iterator& other) const
+    {
+      return set->sparse ? sparse_it != other.sparse_it : current != other.current;
+    }
+  private:
+    const DefSet* set;
+    int current;
+    Sparse::iterator sparse_it;
+  };
+  iterator begin() const
+  {
+    return sparse ? iterator(this, sparse->begin()) : iterator(this, find_next(-1));
+  }
+  iterator end() const
+  {
+    return sparse ? iterator(this, sparse->end()) : iterator(this, -1);
+  }
+
+private:
+  /* first member of a dense set after prev (-1 for the first one), -1 if there is none */
+  int find_next(int prev) const
+  {
+    unsigned i = prev + 1;
+    if (i >= num_bits){
+      return -1;
+    }
+    unsigned w = i / WORD_BITS;
+    Word bits = words[ w ] & (~Word(0) << (i % WORD_BITS));
+    while (bits == 0){
+      if (++w == num_words){
+        return -1;
+      }
+      bits = words[ w ];
+    }
+    return w * WORD_BITS + llvm::countTrailingZeros(bits);
+  }
+
+  Word* words = nullptr;
+  Sparse* sparse = nullptr;
+  unsigned num_bits = 0;
+  unsigned num_words = 0;
+};
+
+/* Form of the sets of a ReachingDefinitionInfo. AUTO_SETS picks sparse sets
+   when dense ones would take a lot of memory (more than SPARSE_MIN_BYTES
+   for the four sets of every block) and definitions are a small part of
+   the index space (under one in SPARSE_MAX_DENSITY instructions), so that
+   memory follows what the sets hold rather than the function size. */
+enum SetRepresentation { AUTO_SETS, DENSE_SETS, SPARSE_SETS };
+const uint64_t SPARSE_MIN_BYTES = 64 << 20;
+const unsigned SPARSE_MAX_DENSITY = 4;
+
+inline bool use_sparse_sets(SetRepresentation representation, unsigned num_blocks,
+                            unsigned universe, unsigned num_defs)
+{
+  if (representation != AUTO_SETS){
+    return representation == SPARSE_SETS;
+  }
+  uint64_t dense_bytes = uint64_t(num_blocks) * 4 * ((universe + DefSet::WORD_BITS - 1) / DefSet::WORD_BITS) * sizeof(DefSet::Word);
+  return dense_bytes > SPARSE_MIN_BYTES && uint64_t(num_defs) * SPARSE_MAX_DENSITY < universe;
+}
+
+/* Reaching definition sets of one function.
+   representation - form of the sets, set it before computing them
+   arena, sparse_arena - own the bits of every DefSet below, freed with the info
+   numbering - index of every instruction, definitions are named by it
+   latest_def_in_block - (Block, varname) to the index of its last store in the block
+   GEN, KILL, IN, OUT - per block sets of store indexes
+*/
+struct ReachingDefinitionInfo
+{
+  SetRepresentation representation = AUTO_SETS;
+  llvm::BumpPtrAllocator arena;
+  llvm::SpecificBumpPtrAllocator<DefSet::Sparse> sparse_arena;
+  bool sparse = false;
+  InstructionNumbering numbering;
+  llvm::DenseMap<std::pair<llvm::BasicBlock*, llvm::StringRef>, int> latest_def_in_block;
+
+  llvm::DenseMap<llvm::BasicBlock*, DefSet> GEN;
+  llvm::DenseMap<llvm::BasicBlock*, DefSet> KILL;
+  llvm::DenseMap<llvm::BasicBlock*, DefSet> IN;
+  llvm::DenseMap<llvm::BasicBlock*, DefSet> OUT;
+
+  /* limit that stopped the iteration, empty if IN/OUT are exact. If set,
+     IN of every block but the entry holds every definition of the function */
+  std::string exceeded;
+
+  DefSet new_set()
+  {
+    if (sparse){
+      return DefSet(new (sparse_arena.Allocate()) DefSet::Sparse(), numbering.size());
+    }
+    return DefSet(arena, numbering.size());
+  }
+};
+
+inline void union_of_pred(llvm::BasicBlock *bb, llvm::DenseMap<llvm::BasicBlock*, DefSet>& OUT, DefSet& result)
+{
+  result.clear();
+
+  /* get the predecessors */
+  for (auto PI = llvm::pred_begin(bb), E = llvm::pred_end(bb); PI != E; ++PI)
+  {
+    llvm::BasicBlock *pred = *PI;
+    result.union_with(OUT[pred]);
+  }
+}
+
+inline void getOutSet(const DefSet& gen, const DefSet& in, const DefSet& kill, DefSet& result)
+{
+  result.transfer(gen, in, kill);
+}
+
+/* variable defined by a store, empty if it is not a named location */
+inline llvm::StringRef defined_var(llvm::Instruction* inst)
+{
+  llvm::StoreInst *store_instruction = llvm::dyn_cast<llvm::StoreInst>(inst);
+  if (store_instruction && store_instruction->getPointerOperand()->hasName()){
+    return store_instruction->getPointerOperand()->getName();
+  }
+  return llvm::StringRef();
+}
+
+inline void compute_reaching_definitions(llvm::Function &F, ReachingDefinitionInfo &info,
+                                         const AnalysisBudget& budget = AnalysisBudget())
+{
+  /* Index */
+  info.numbering.number(F);
+  unsigned num_defs = 0;
+  for (unsigned i = 0; i < info.numbering.size(); i++)
+  {
+    /* If instruction is store operation, remember the latest def of the var */
+    llvm::StringRef var_name = defined_var(info.numbering[ i ]);
+    if (!var_name.empty()){
+      info.latest_def_in_block[ std::make_pair(info.numbering[ i ]->getParent(), var_name) ] = i;
+      num_defs++;
+    }
+  }
+  info.sparse = use_sparse_sets(info.representation, F.size(), info.numbering.size(), num_defs);
+
+  DefSet all_defs = info.new_set();
+  for (auto &basic_block : F){
+    info.GEN [ &basic_block ] = info.new_set();
+    info.KILL [ &basic_block ] = info.new_set();
+    info.IN [ &basic_block ] = info.new_set();
+    info.OUT [ &basic_block ] = info.new_set();
+  }
+
+  for (auto &basic_block : F)
+  {
+    /* kill gen set for each block */
+    DefSet& gen = info.GEN [ &basic_block ];
+    DefSet& kill = info.KILL [ &basic_block ];
+
+    /* Gen Set : definitions within Basic Block (B) that reach the end of B */
+    for (int i = info.numbering.block_begin(&basic_block); i < (int)info.numbering.block_end(&basic_block); i++)
+    {
+      llvm::StringRef var_name = defined_var(info.numbering[ i ]);
+      if (!var_name.empty()){
+        all_defs.set(i);
+
+        /* Only add definitions that reach */
+        auto latest = info.latest_def_in_block.find(std::make_pair(&basic_block, var_name));
+        if (latest != info.latest_def_in_block.end()){
+          gen.set(latest->second);
+
+          /* if the index of the varname is different add to kill set */
+          if (i != latest->second){
+            kill.set(i);
+          }
+        }
+
+        /* Other additions to Kill Set */
+        /* what are all the defintions found in the predecessors */
+        for (auto PI = llvm::pred_begin(&basic_block), E = llvm::pred_end(&basic_block); PI != E; ++PI) {
+            llvm::BasicBlock *Pred = *PI;
+            auto prev = info.latest_def_in_block.find(std::make_pair(Pred, var_name));
+
+            if ((prev != info.latest_def_in_block.end()) &&
+                 (latest != info.latest_def_in_block.end()) && gen.test(latest->second)){
+
+                  kill.set(prev->second);
+            }
+        }
+      }
+    }
+  }
+
+  /* iterate IN/OUT until no OUT set changes, back edges need more than one sweep */
+  DefSet out = info.new_set();
+  bool changed = true;
+  unsigned sweeps = 0;
+  while (changed){
+    changed = false;
+
+    /* out of budget: give up on the fixpoint, every definition may reach
+       every block, a sound but useless answer for the clients */
+    info.exceeded = budget.exceeded(F.size(), all_defs.count(), ++sweeps);
+    if (!info.exceeded.empty()){
+      for (auto &basic_block : F){
+        if (&basic_block == &F.getEntryBlock()){
+          info.IN [ &basic_block ].clear();
+        }else{
+          info.IN [ &basic_block ].copy_from(all_defs);
+        }
+        getOutSet(info.GEN [&basic_block], info.IN[ &basic_block ], info.KILL[ &basic_block], info.OUT[ &basic_block ]);
+      }
+      return;
+    }
+
+    for (auto &basic_block : F){
+
+      /* if entry block IN[B] = null */
+      if (&basic_block == &F.getEntryBlock()){
+        info.IN [ &basic_block ].clear();
+      }else{
+        union_of_pred(&basic_block, info.OUT, info.IN [ &basic_block ]);
+      }
+
+      getOutSet(info.GEN [&basic_block], info.IN[ &basic_block ], info.KILL[ &basic_block], out);
+      if (!out.equals(info.OUT[ &basic_block ])){
+        info.OUT[ &basic_block ].copy_from(out);
+        changed = true;
+      }
+    }
+  }
+}
+
+/* indexes (increasing) of the stores to var_name that reach the point just
+   before inst */
+inline llvm::SmallVector<int, 4> defs_of_var_reaching(llvm::Instruction* inst, llvm::StringRef var_name,
+                                                      ReachingDefinitionInfo &info)
+{
+  llvm::SmallVector<int, 4> result;
+
+  /* a store earlier in the same block hides everything coming in */
+  llvm::BasicBlock* bb = inst->getParent();
+  for (auto it = inst->getIterator(); it != bb->begin(); ){
+    --it;
+    if (defined_var(&*it) == var_name){
+      result.push_back(info.numbering.index_of(&*it));
+      return result;
+    }
+  }
+
+  for (int d : info.IN[ bb ]){
+    if (defined_var(info.numbering[ d ]) == var_name){
+      result.push_back(d);
+    }
+  }
+  return result;
+}
+
+/* indexes of the stores to the loaded variable that reach a load */
+inline llvm::SmallVector<int, 4> defs_reaching_load(llvm::LoadInst* load, ReachingDefinitionInfo &info)
+{
+  if (!load->getPointerOperand()->hasName()){
+    return llvm::SmallVector<int, 4>();
+  }
+  return defs_of_var_reaching(load, load->getPointerOperand()->getName(), info);
+}
+
+/* Only locals whose address never escapes are safe to reason about with
+   reaching definitions, anything else can be written behind our back */
+inline bool is_tracked_var(llvm::Value* ptr)
+{
+  llvm::AllocaInst* alloca_inst = llvm::dyn_cast<llvm::AllocaInst>(ptr);
+  return alloca_inst && alloca_inst->hasName() && llvm::isAllocaPromotable(alloca_inst);
+}
+
+#endif
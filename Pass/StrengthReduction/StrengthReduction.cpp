@@ -0,0 +1,374 @@
+#include "llvm/Pass.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/IR/Type.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Transforms/Utils/Local.h"
+#include <string>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "ReachingDefinition/ReachingDefinition.h"
+
+using namespace llvm;
+using namespace std;
+
+#define DEBUG_TYPE "StrengthReduction"
+
+namespace
+{
+
+/* basic induction variable: the only store to var in the loop is
+   var = var + step, with the load, the add and the store in one block */
+struct InductionVariable
+{
+  llvm::Value* var;
+  llvm::StoreInst* update;
+  llvm::ConstantInt* step;
+  /* the update is an add/sub nsw, so sext(i) steps by sext(step) */
+  bool no_signed_wrap;
+};
+
+/* i = i + C, i = C + i or i = i - C */
+bool match_increment(llvm::StoreInst* store_instruction, InductionVariable& iv)
+{
+  BinaryOperator* op = dyn_cast<BinaryOperator>(store_instruction->getValueOperand());
+  if (op == nullptr || (op->getOpcode() != Instruction::Add && op->getOpcode() != Instruction::Sub)){
+    return false;
+  }
+
+  LoadInst* load_instruction = dyn_cast<LoadInst>(op->getOperand(0));
+  ConstantInt* step = dyn_cast<ConstantInt>(op->getOperand(1));
+  if (op->getOpcode() == Instruction::Add && load_instruction == nullptr){
+    load_instruction = dyn_cast<LoadInst>(op->getOperand(1));
+    step = dyn_cast<ConstantInt>(op->getOperand(0));
+  }
+  if (load_instruction == nullptr || step == nullptr ||
+      load_instruction->getPointerOperand() != store_instruction->getPointerOperand() ||
+      load_instruction->getParent() != store_instruction->getParent() ||
+      op->getParent() != store_instruction->getParent()){
+    return false;
+  }
+
+  iv.var = store_instruction->getPointerOperand();
+  iv.update = store_instruction;
+  iv.step = step;
+  iv.no_signed_wrap = op->hasNoSignedWrap();
+  if (op->getOpcode() == Instruction::Sub){
+    iv.step = ConstantInt::get(step->getContext(), -step->getValue());
+  }
+  return true;
+}
+
+std::vector<InductionVariable> find_induction_variables(Loop* loop)
+{
+  /* collect the stores of every local in the loop */
+  std::map<llvm::Value*, std::vector<llvm::StoreInst*>> stores;
+  std::vector<llvm::Value*> order;
+  for (auto *basic_block : loop->getBlocks()){
+    for (auto &inst : *basic_block){
+      StoreInst* store_instruction = dyn_cast<StoreInst>(&inst);
+      if (store_instruction && !store_instruction->isVolatile() &&
+          is_tracked_var(store_instruction->getPointerOperand())){
+        if (stores.find(store_instruction->getPointerOperand()) == stores.end()){
+          order.push_back(store_instruction->getPointerOperand());
+        }
+        stores[ store_instruction->getPointerOperand() ].push_back(store_instruction);
+      }
+    }
+  }
+
+  std::vector<InductionVariable> result;
+  for (auto *var : order){
+    InductionVariable iv;
+    if (stores[ var ].size() == 1 && match_increment(stores[ var ][ 0 ], iv)){
+      result.push_back(iv);
+    }
+  }
+  return result;
+}
+
+/* true when the load of iv.var that inst depends on comes after any update of i in its block */
+bool loaded_before_use(llvm::LoadInst* load_instruction, llvm::Instruction* inst, InductionVariable& iv)
+{
+  if (load_instruction->getParent() != inst->getParent()){
+    return false;
+  }
+  for (llvm::Instruction* it = load_instruction; it != inst; it = it->getNextNode()){
+    if (it == iv.update){
+      return false;
+    }
+  }
+  return true;
+}
+
+/* mul (load i), K with no update of i between the load and the multiplication */
+bool match_scaled_iv(llvm::Instruction* inst, InductionVariable& iv, llvm::ConstantInt*& factor)
+{
+  if (inst->getOpcode() != Instruction::Mul){
+    return false;
+  }
+  LoadInst* load_instruction = dyn_cast<LoadInst>(inst->getOperand(0));
+  factor = dyn_cast<ConstantInt>(inst->getOperand(1));
+  if (load_instruction == nullptr){
+    load_instruction = dyn_cast<LoadInst>(inst->getOperand(1));
+    factor = dyn_cast<ConstantInt>(inst->getOperand(0));
+  }
+  return load_instruction && factor && load_instruction->getPointerOperand() == iv.var &&
+         loaded_before_use(load_instruction, inst, iv);
+}
+
+/* An address &base[...][i + C] computed in the loop, the form -O0 gives
+   array indexing: the last GEP index is load i, possibly plus or minus a
+   constant and sign extended, and the other indices are constants. */
+struct ScaledAddress
+{
+  llvm::GetElementPtrInst* gep;
+  llvm::LoadInst* load;
+  llvm::ConstantInt* offset;
+  bool extended;
+};
+
+bool match_scaled_address(llvm::Instruction* inst, Loop* loop, InductionVariable& iv, ScaledAddress& address)
+{
+  GetElementPtrInst* gep = dyn_cast<GetElementPtrInst>(inst);
+  if (gep == nullptr || !loop->isLoopInvariant(gep->getPointerOperand())){
+    return false;
+  }
+  for (unsigned i = 1; i + 1 < gep->getNumOperands(); i++){
+    if (!isa<ConstantInt>(gep->getOperand(i))){
+      return false;
+    }
+  }
+
+  llvm::Value* index = gep->getOperand(gep->getNumOperands() - 1);
+  address.gep = gep;
+  address.offset = nullptr;
+  address.extended = false;
+  if (SExtInst* extend = dyn_cast<SExtInst>(index)){
+    /* sext(i + step) = sext(i) + sext(step) needs an nsw update */
+    if (!iv.no_signed_wrap){
+      return false;
+    }
+    index = extend->getOperand(0);
+    address.extended = true;
+  }
+  /* i + C, C + i or i - C, kept as the offset C or -C */
+  BinaryOperator* op = dyn_cast<BinaryOperator>(index);
+  if (op && (op->getOpcode() == Instruction::Add || op->getOpcode() == Instruction::Sub) &&
+      (!address.extended || op->hasNoSignedWrap())){
+    address.offset = dyn_cast<ConstantInt>(op->getOperand(1));
+    index = op->getOperand(0);
+    if (address.offset == nullptr && op->getOpcode() == Instruction::Add){
+      address.offset = dyn_cast<ConstantInt>(op->getOperand(0));
+      index = op->getOperand(1);
+    }
+    if (address.offset == nullptr || (op->getOpcode() == Instruction::Sub && address.offset->isMinValue(true))){
+      return false;
+    }
+    if (op->getOpcode() == Instruction::Sub){
+      address.offset = ConstantInt::get(address.offset->getContext(), -address.offset->getValue());
+    }
+  }
+  address.load = dyn_cast<LoadInst>(index);
+  return address.load && address.load->getPointerOperand() == iv.var &&
+         loaded_before_use(address.load, gep, iv);
+}
+
+/* same base, indices and offset, so one pointer serves both */
+bool same_address(ScaledAddress& a, ScaledAddress& b)
+{
+  if (a.gep->getSourceElementType() != b.gep->getSourceElementType() ||
+      a.gep->getNumOperands() != b.gep->getNumOperands() ||
+      a.extended != b.extended || a.offset != b.offset){
+    return false;
+  }
+  for (unsigned i = 0; i + 1 < a.gep->getNumOperands(); i++){
+    if (a.gep->getOperand(i) != b.gep->getOperand(i)){
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Replace &base[i + C] inside the loop by a pointer p kept equal to it:
+   p = &base[i + C] in the preheader and p = p + step after every update
+   of i. The scaling by the element size the GEP does goes with it.
+   Returns the number of addresses replaced. */
+int reduce_addresses(Loop* loop, Function &F, InductionVariable& iv)
+{
+  std::vector<std::vector<ScaledAddress>> groups;
+  for (auto *basic_block : loop->getBlocks()){
+    for (auto &inst : *basic_block){
+      ScaledAddress address;
+      if (!match_scaled_address(&inst, loop, iv, address)){
+        continue;
+      }
+      bool found = false;
+      for (auto &group : groups){
+        if (same_address(group[ 0 ], address)){
+          group.push_back(address);
+          found = true;
+          break;
+        }
+      }
+      if (!found){
+        groups.push_back({address});
+      }
+    }
+  }
+
+  int reduced = 0;
+  for (auto &group : groups){
+    ScaledAddress& first = group[ 0 ];
+    llvm::Type* type = first.gep->getType();
+    llvm::Type* iv_type = first.load->getType();
+    std::string name = iv.var->getName().str() + ".ptr";
+
+    IRBuilder<> Entry(&*F.getEntryBlock().getFirstInsertionPt());
+    AllocaInst* temp = Entry.CreateAlloca(type, nullptr, name);
+
+    /* the address for the value i has on entry, built like the one in the loop */
+    IRBuilder<> Pre(loop->getLoopPreheader()->getTerminator());
+    llvm::Value* index = Pre.CreateLoad(iv_type, iv.var);
+    if (first.offset){
+      index = Pre.CreateAdd(index, first.offset, "", false, first.extended);
+    }
+    if (first.extended){
+      index = Pre.CreateSExt(index, first.gep->getOperand(first.gep->getNumOperands() - 1)->getType());
+    }
+    std::vector<llvm::Value*> indices(first.gep->idx_begin(), first.gep->idx_end());
+    indices.back() = index;
+    Pre.CreateStore(Pre.CreateGEP(first.gep->getSourceElementType(), first.gep->getPointerOperand(), indices), temp);
+
+    /* the last index steps over the result element type */
+    IRBuilder<> Update(iv.update->getNextNode());
+    llvm::Type* index_type = indices.back()->getType();
+    llvm::Constant* step = ConstantInt::get(index_type, iv.step->getValue().sextOrTrunc(index_type->getIntegerBitWidth()));
+    Update.CreateStore(Update.CreateGEP(first.gep->getResultElementType(), Update.CreateLoad(type, temp), step), temp);
+
+    errs() << "Loop " << loop->getHeader()->getName() << ": &" << first.gep->getPointerOperand()->getName()
+           << "[" << iv.var->getName();
+    if (first.offset && first.offset->isNegative()){
+      errs() << " - " << -first.offset->getValue();
+    }else if (first.offset){
+      errs() << " + " << first.offset->getValue();
+    }
+    errs() << "] replaced by " << temp->getName() << " += " << iv.step->getValue() << "\n";
+
+    for (auto &address : group){
+      llvm::Value* operand = address.gep->getOperand(address.gep->getNumOperands() - 1);
+      LoadInst* reload = new LoadInst(type, temp, name, address.gep);
+      address.gep->replaceAllUsesWith(reload);
+      address.gep->eraseFromParent();
+      RecursivelyDeleteTriviallyDeadInstructions(operand);
+      reduced++;
+    }
+  }
+  return reduced;
+}
+
+/* Replace i * K inside the loop by a variable t kept equal to i * K:
+   t = i * K in the preheader and t = t + step * K after every update of i.
+   Returns the number of multiplications replaced, the addresses replaced
+   are added to addresses. */
+int reduce_loop(Loop* loop, Function &F, int& addresses)
+{
+  llvm::BasicBlock* preheader = loop->getLoopPreheader();
+  if (preheader == nullptr){
+    return 0;
+  }
+
+  int reduced = 0;
+  for (auto &iv : find_induction_variables(loop)){
+    addresses += reduce_addresses(loop, F, iv);
+
+    /* group the multiplications by factor, each factor gets one derived variable */
+    std::map<llvm::ConstantInt*, std::vector<llvm::Instruction*>> by_factor;
+    std::vector<llvm::ConstantInt*> factors;
+    for (auto *basic_block : loop->getBlocks()){
+      for (auto &inst : *basic_block){
+        llvm::ConstantInt* factor;
+        if (match_scaled_iv(&inst, iv, factor)){
+          if (by_factor.find(factor) == by_factor.end()){
+            factors.push_back(factor);
+          }
+          by_factor[ factor ].push_back(&inst);
+        }
+      }
+    }
+
+    for (auto *factor : factors){
+      llvm::Type* type = factor->getType();
+      std::string name = iv.var->getName().str() + ".sr";
+
+      IRBuilder<> Entry(&*F.getEntryBlock().getFirstInsertionPt());
+      AllocaInst* temp = Entry.CreateAlloca(type, nullptr, name);
+
+      IRBuilder<> Pre(preheader->getTerminator());
+      Pre.CreateStore(Pre.CreateMul(Pre.CreateLoad(type, iv.var), factor), temp);
+
+      IRBuilder<> Update(iv.update->getNextNode());
+      llvm::Constant* increment = ConstantInt::get(type->getContext(), iv.step->getValue() * factor->getValue());
+      Update.CreateStore(Update.CreateAdd(Update.CreateLoad(type, temp), increment), temp);
+
+      for (auto *inst : by_factor[ factor ]){
+        llvm::Value* operand = isa<LoadInst>(inst->getOperand(0)) ? inst->getOperand(0) : inst->getOperand(1);
+        LoadInst* reload = new LoadInst(type, temp, name, inst);
+        inst->replaceAllUsesWith(reload);
+        inst->eraseFromParent();
+        RecursivelyDeleteTriviallyDeadInstructions(operand);
+        reduced++;
+      }
+
+      errs() << "Loop " << loop->getHeader()->getName() << ": " << iv.var->getName()
+             << " * " << factor->getValue() << " replaced by " << temp->getName()
+             << " += " << iv.step->getValue() * factor->getValue() << "\n";
+    }
+  }
+  return reduced;
+}
+
+struct StrengthReduction : public FunctionPass
+{
+  static char ID;
+  StrengthReduction() : FunctionPass(ID) {}
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override
+  {
+    AU.addRequired<LoopInfoWrapperPass>();
+    AU.setPreservesCFG();
+  }
+
+  bool runOnFunction(Function &F) override
+  {
+    errs() << "StrengthReduction: ";
+    errs() << F.getName() << "\n";
+
+    LoopInfo &LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+
+    int reduced = 0;
+    int addresses = 0;
+    SmallVector<Loop*, 8> loops = LI.getLoopsInPreorder();
+    for (auto it = loops.rbegin(); it != loops.rend(); ++it){
+      reduced += reduce_loop(*it, F, addresses);
+    }
+
+    errs() << "Multiplications reduced: " << reduced << "\n";
+    errs() << "Addresses reduced: " << addresses << "\n";
+    return reduced != 0 || addresses != 0;
+  }
+}; // end of struct StrengthReduction
+} // end of anonymous namespace
+
+char StrengthReduction::ID = 0;
+static RegisterPass<StrengthReduction> X("StrengthReduction", "Strength Reduction Pass",
+                                      false /* Only looks at CFG */,
+                                      false /* Analysis Pass */);
@@ -0,0 +1,67 @@
+; Everything a streamed -o has to carry besides the bodies: a named struct
+; type, globals, an alias, declarations, attribute groups on functions and
+; call sites, and named and loop metadata.
+source_filename = "module.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+%struct.pair = type { i32, i32 }
+%struct.node = type { %struct.pair, %struct.node* }
+
+@table = dso_local global [4 x i32] [i32 1, i32 2, i32 3, i32 4], align 16
+@origin = internal global %struct.pair zeroinitializer, align 4
+@first = dso_local alias i32, getelementptr inbounds ([4 x i32], [4 x i32]* @table, i64 0, i64 0)
+
+declare i32 @external(i32) #1
+
+define dso_local i32 @sum(i32 %n) #0 {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %next, %loop ]
+  %acc = phi i32 [ 0, %entry ], [ %add, %loop ]
+  %idx = sext i32 %i to i64
+  %slot = getelementptr inbounds [4 x i32], [4 x i32]* @table, i64 0, i64 %idx
+  %v = load i32, i32* %slot, align 4, !tbaa !4
+  %a = add nsw i32 %v, %v
+  %b = add nsw i32 %v, %v
+  %c = add nsw i32 %a, %b
+  %add = add nsw i32 %acc, %c
+  %next = add nsw i32 %i, 1
+  %done = icmp sge i32 %next, 4
+  br i1 %done, label %exit, label %loop, !llvm.loop !8
+
+exit:
+  %r = call i32 @external(i32 %add) #2
+  ret i32 %r
+}
+
+define dso_local i32 @walk(%struct.node* %n) #0 {
+entry:
+  %p = getelementptr inbounds %struct.node, %struct.node* %n, i32 0, i32 0, i32 1
+  %x = load i32, i32* %p, align 4
+  %q = getelementptr inbounds %struct.node, %struct.node* %n, i32 0, i32 0, i32 1
+  %y = load i32, i32* %q, align 4
+  %s = add nsw i32 %x, %y
+  %o = load i32, i32* getelementptr inbounds (%struct.pair, %struct.pair* @origin, i32 0, i32 0), align 4
+  %t = add nsw i32 %s, %o
+  ret i32 %t
+}
+
+attributes #0 = { noinline nounwind uwtable "frame-pointer"="all" }
+attributes #1 = { "frame-pointer"="all" }
+attributes #2 = { nounwind readnone }
+
+!llvm.module.flags = !{!0, !1}
+!llvm.ident = !{!2}
+
+!0 = !{i32 1, !"wchar_size", i32 4}
+!1 = !{i32 7, !"uwtable", i32 1}
+!2 = !{!"clang version 14.0.0"}
+!3 = !{!"Simple C/C++ TBAA"}
+!4 = !{!5, !5, i64 0}
+!5 = !{!"int", !6, i64 0}
+!6 = !{!"omnipotent char", !3, i64 0}
+!7 = !{!"llvm.loop.mustprogress"}
+!8 = distinct !{!8, !7}
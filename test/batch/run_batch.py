@@ -0,0 +1,70 @@
+import argparse, glob, os, subprocess, sys, tempfile
+# Streamed output of BatchDriver.
+#
+#   python3 run_batch.py --build <pass build dir>
+#
+# Every module here, in test/bench and in the phase tests is run through
+# CSElimination by BatchDriver twice, once whole (-S -o) and once with
+# -stream -o. The streamed text must be read back by llvm-as and, written
+# out again by llvm-dis, be the module the whole run wrote.
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TEST = os.path.dirname(HERE)
+
+
+def corpus():
+    paths = glob.glob(os.path.join(HERE, "*.ll"))
+    paths += glob.glob(os.path.join(TEST, "bench", "*.ll"))
+    paths += glob.glob(os.path.join(TEST, "phase*", "*.ll"))
+    return sorted(paths)
+
+
+def read_back(path, args):
+    """the module in path as llvm-dis writes it, None if llvm-as rejects it"""
+    assembled = subprocess.run([args.llvm_as, path, "-o", "-"], stdout=subprocess.PIPE,
+                               stderr=subprocess.PIPE)
+    if assembled.returncode != 0:
+        print(assembled.stderr.decode(), end="")
+        return None
+    return subprocess.run([args.llvm_dis, "-o", "-"], input=assembled.stdout,
+                          stdout=subprocess.PIPE, check=True).stdout
+
+
+def main():
+    parser = argparse.ArgumentParser(description="streamed output of BatchDriver")
+    parser.add_argument("--build", required=True, help="build directory of the passes")
+    parser.add_argument("--llvm-as", default="llvm-as")
+    parser.add_argument("--llvm-dis", default="llvm-dis")
+    args = parser.parse_args()
+
+    driver = os.path.join(args.build, "BatchDriver", "BatchDriver")
+    library = os.path.join(args.build, "CSElimination", "libCSElimination.so")
+    command = [driver, "-load", library, "-CSElimination", "-cse-pre"]
+    failures = 0
+    with tempfile.TemporaryDirectory() as workdir:
+        for path in corpus():
+            name = os.path.relpath(path, TEST)
+            whole = os.path.join(workdir, "whole.ll")
+            streamed = os.path.join(workdir, "streamed.ll")
+            subprocess.check_call(command + [path, "-S", "-o", whole], stderr=subprocess.DEVNULL)
+            subprocess.check_call(command + [path, "-stream", "-o", streamed], stderr=subprocess.DEVNULL)
+
+            expected = read_back(whole, args)
+            result = read_back(streamed, args)
+            if result is None:
+                failures += 1
+                print("FAIL %s: streamed output does not read back" % name)
+            elif result != expected:
+                failures += 1
+                print("FAIL %s: streamed output differs from the whole module" % name)
+            else:
+                print("ok   %s" % name)
+
+    if failures:
+        print("%d modules streamed wrongly" % failures)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
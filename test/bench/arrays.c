@@ -0,0 +1,17 @@
+/* a[i] is read and written by one statement and b[i] is read twice; every
+   access computes its address again */
+int a[1024], b[1024];
+
+long kernel(int n)
+{
+  long s = 0;
+  int r, i;
+  for (r = 0; r < n; r++) {
+    for (i = 0; i < 1024; i++) {
+      a[i] = (a[i] + b[i] * b[i] + r) & 65535;
+      b[i] = (b[i] + i) & 255;
+    }
+    s += a[r & 1023];
+  }
+  return s;
+}
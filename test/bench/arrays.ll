@@ -0,0 +1,109 @@
+; ModuleID = 'arrays.c'
+source_filename = "arrays.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@a = dso_local global [1024 x i32] zeroinitializer, align 16
+@b = dso_local global [1024 x i32] zeroinitializer, align 16
+
+; Function Attrs: noinline nounwind uwtable
+define dso_local i64 @kernel(i32 %n) #0 {
+entry:
+  %n.addr = alloca i32, align 4
+  %s = alloca i64, align 8
+  %r = alloca i32, align 4
+  %i = alloca i32, align 4
+  store i32 %n, i32* %n.addr, align 4
+  store i64 0, i64* %s, align 8
+  store i32 0, i32* %r, align 4
+  br label %for.cond
+
+for.cond:                                         ; preds = %for.inc22, %entry
+  %0 = load i32, i32* %r, align 4
+  %1 = load i32, i32* %n.addr, align 4
+  %cmp = icmp slt i32 %0, %1
+  br i1 %cmp, label %for.body, label %for.end24
+
+for.body:                                         ; preds = %for.cond
+  store i32 0, i32* %i, align 4
+  br label %for.cond1
+
+for.cond1:                                        ; preds = %for.inc, %for.body
+  %2 = load i32, i32* %i, align 4
+  %cmp2 = icmp slt i32 %2, 1024
+  br i1 %cmp2, label %for.body3, label %for.end
+
+for.body3:                                        ; preds = %for.cond1
+  %3 = load i32, i32* %i, align 4
+  %idxprom = sext i32 %3 to i64
+  %arrayidx = getelementptr inbounds [1024 x i32], [1024 x i32]* @a, i64 0, i64 %idxprom
+  %4 = load i32, i32* %arrayidx, align 4
+  %5 = load i32, i32* %i, align 4
+  %idxprom4 = sext i32 %5 to i64
+  %arrayidx5 = getelementptr inbounds [1024 x i32], [1024 x i32]* @b, i64 0, i64 %idxprom4
+  %6 = load i32, i32* %arrayidx5, align 4
+  %7 = load i32, i32* %i, align 4
+  %idxprom6 = sext i32 %7 to i64
+  %arrayidx7 = getelementptr inbounds [1024 x i32], [1024 x i32]* @b, i64 0, i64 %idxprom6
+  %8 = load i32, i32* %arrayidx7, align 4
+  %mul = mul nsw i32 %6, %8
+  %add = add nsw i32 %4, %mul
+  %9 = load i32, i32* %r, align 4
+  %add8 = add nsw i32 %add, %9
+  %and = and i32 %add8, 65535
+  %10 = load i32, i32* %i, align 4
+  %idxprom9 = sext i32 %10 to i64
+  %arrayidx10 = getelementptr inbounds [1024 x i32], [1024 x i32]* @a, i64 0, i64 %idxprom9
+  store i32 %and, i32* %arrayidx10, align 4
+  %11 = load i32, i32* %i, align 4
+  %idxprom11 = sext i32 %11 to i64
+  %arrayidx12 = getelementptr inbounds [1024 x i32], [1024 x i32]* @b, i64 0, i64 %idxprom11
+  %12 = load i32, i32* %arrayidx12, align 4
+  %13 = load i32, i32* %i, align 4
+  %add13 = add nsw i32 %12, %13
+  %and14 = and i32 %add13, 255
+  %14 = load i32, i32* %i, align 4
+  %idxprom15 = sext i32 %14 to i64
+  %arrayidx16 = getelementptr inbounds [1024 x i32], [1024 x i32]* @b, i64 0, i64 %idxprom15
+  store i32 %and14, i32* %arrayidx16, align 4
+  br label %for.inc
+
+for.inc:                                          ; preds = %for.body3
+  %15 = load i32, i32* %i, align 4
+  %inc = add nsw i32 %15, 1
+  store i32 %inc, i32* %i, align 4
+  br label %for.cond1, !llvm.loop !2
+
+for.end:                                          ; preds = %for.cond1
+  %16 = load i32, i32* %r, align 4
+  %and17 = and i32 %16, 1023
+  %idxprom18 = sext i32 %and17 to i64
+  %arrayidx19 = getelementptr inbounds [1024 x i32], [1024 x i32]* @a, i64 0, i64 %idxprom18
+  %17 = load i32, i32* %arrayidx19, align 4
+  %conv = sext i32 %17 to i64
+  %18 = load i64, i64* %s, align 8
+  %add20 = add nsw i64 %18, %conv
+  store i64 %add20, i64* %s, align 8
+  br label %for.inc22
+
+for.inc22:                                        ; preds = %for.end
+  %19 = load i32, i32* %r, align 4
+  %inc23 = add nsw i32 %19, 1
+  store i32 %inc23, i32* %r, align 4
+  br label %for.cond, !llvm.loop !4
+
+for.end24:                                        ; preds = %for.cond
+  %20 = load i64, i64* %s, align 8
+  ret i64 %20
+}
+
+attributes #0 = { noinline nounwind uwtable "disable-tail-calls"="false" "frame-pointer"="all" "less-precise-fpmad"="false" "min-legal-vector-width"="0" "no-infs-fp-math"="false" "no-jump-tables"="false" "no-nans-fp-math"="false" "no-signed-zeros-fp-math"="false" "no-trapping-math"="true" "stack-protector-buffer-size"="8" "target-cpu"="x86-64" "target-features"="+cx8,+fxsr,+mmx,+sse,+sse2,+x87" "tune-cpu"="generic" "unsafe-fp-math"="false" "use-soft-float"="false" }
+
+!llvm.module.flags = !{!0}
+!llvm.ident = !{!1}
+
+!0 = !{i32 1, !"wchar_size", i32 4}
+!1 = !{!"clang version 12.0.1"}
+!2 = distinct !{!2, !3}
+!3 = !{!"llvm.loop.mustprogress"}
+!4 = distinct !{!4, !3}
@@ -0,0 +1,16 @@
+/* x + y is computed on both sides of a branch and again at the join */
+long kernel(int n)
+{
+  long s = 0;
+  int i, x, y;
+  for (i = 0; i < n; i++) {
+    x = i & 255;
+    y = i >> 3;
+    if (i & 1)
+      s += x + y;
+    else
+      s -= x + y;
+    s += (x + y) * 2;
+  }
+  return s;
+}
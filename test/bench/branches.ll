@@ -0,0 +1,87 @@
+; ModuleID = 'branches.c'
+source_filename = "branches.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; Function Attrs: noinline nounwind uwtable
+define dso_local i64 @kernel(i32 %n) #0 {
+entry:
+  %n.addr = alloca i32, align 4
+  %s = alloca i64, align 8
+  %i = alloca i32, align 4
+  %x = alloca i32, align 4
+  %y = alloca i32, align 4
+  store i32 %n, i32* %n.addr, align 4
+  store i64 0, i64* %s, align 8
+  store i32 0, i32* %i, align 4
+  br label %for.cond
+
+for.cond:                                         ; preds = %for.inc, %entry
+  %0 = load i32, i32* %i, align 4
+  %1 = load i32, i32* %n.addr, align 4
+  %cmp = icmp slt i32 %0, %1
+  br i1 %cmp, label %for.body, label %for.end
+
+for.body:                                         ; preds = %for.cond
+  %2 = load i32, i32* %i, align 4
+  %and = and i32 %2, 255
+  store i32 %and, i32* %x, align 4
+  %3 = load i32, i32* %i, align 4
+  %shr = ashr i32 %3, 3
+  store i32 %shr, i32* %y, align 4
+  %4 = load i32, i32* %i, align 4
+  %and1 = and i32 %4, 1
+  %tobool = icmp ne i32 %and1, 0
+  br i1 %tobool, label %if.then, label %if.else
+
+if.then:                                          ; preds = %for.body
+  %5 = load i32, i32* %x, align 4
+  %6 = load i32, i32* %y, align 4
+  %add = add nsw i32 %5, %6
+  %conv = sext i32 %add to i64
+  %7 = load i64, i64* %s, align 8
+  %add2 = add nsw i64 %7, %conv
+  store i64 %add2, i64* %s, align 8
+  br label %if.end
+
+if.else:                                          ; preds = %for.body
+  %8 = load i32, i32* %x, align 4
+  %9 = load i32, i32* %y, align 4
+  %add3 = add nsw i32 %8, %9
+  %conv4 = sext i32 %add3 to i64
+  %10 = load i64, i64* %s, align 8
+  %sub = sub nsw i64 %10, %conv4
+  store i64 %sub, i64* %s, align 8
+  br label %if.end
+
+if.end:                                           ; preds = %if.else, %if.then
+  %11 = load i32, i32* %x, align 4
+  %12 = load i32, i32* %y, align 4
+  %add5 = add nsw i32 %11, %12
+  %mul = mul nsw i32 %add5, 2
+  %conv6 = sext i32 %mul to i64
+  %13 = load i64, i64* %s, align 8
+  %add7 = add nsw i64 %13, %conv6
+  store i64 %add7, i64* %s, align 8
+  br label %for.inc
+
+for.inc:                                          ; preds = %if.end
+  %14 = load i32, i32* %i, align 4
+  %inc = add nsw i32 %14, 1
+  store i32 %inc, i32* %i, align 4
+  br label %for.cond, !llvm.loop !2
+
+for.end:                                          ; preds = %for.cond
+  %15 = load i64, i64* %s, align 8
+  ret i64 %15
+}
+
+attributes #0 = { noinline nounwind uwtable "disable-tail-calls"="false" "frame-pointer"="all" "less-precise-fpmad"="false" "min-legal-vector-width"="0" "no-infs-fp-math"="false" "no-jump-tables"="false" "no-nans-fp-math"="false" "no-signed-zeros-fp-math"="false" "no-trapping-math"="true" "stack-protector-buffer-size"="8" "target-cpu"="x86-64" "target-features"="+cx8,+fxsr,+mmx,+sse,+sse2,+x87" "tune-cpu"="generic" "unsafe-fp-math"="false" "use-soft-float"="false" }
+
+!llvm.module.flags = !{!0}
+!llvm.ident = !{!1}
+
+!0 = !{i32 1, !"wchar_size", i32 4}
+!1 = !{!"clang version 12.0.1"}
+!2 = distinct !{!2, !3}
+!3 = !{!"llvm.loop.mustprogress"}
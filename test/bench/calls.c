@@ -0,0 +1,27 @@
+/* pure helpers called again with the same arguments; lookup reads memory,
+   so the store to table in between keeps its second call */
+int table[256];
+
+__attribute__((const)) int mix(int x, int y)
+{
+  return (x * 31 + y) & 1023;
+}
+
+__attribute__((pure)) int lookup(int i)
+{
+  return table[i & 255];
+}
+
+long kernel(int n)
+{
+  long s = 0;
+  int i, k;
+  for (i = 0; i < n; i++) {
+    k = i & 255;
+    s += mix(k, 3) + lookup(k);
+    s += mix(k, 3) * lookup(k);
+    table[k] = s & 127;
+    s += lookup(k);
+  }
+  return s;
+}
@@ -0,0 +1,114 @@
+; ModuleID = 'calls.c'
+source_filename = "calls.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@table = dso_local global [256 x i32] zeroinitializer, align 16
+
+; Function Attrs: noinline nounwind readnone uwtable
+define dso_local i32 @mix(i32 %x, i32 %y) #1 {
+entry:
+  %x.addr = alloca i32, align 4
+  %y.addr = alloca i32, align 4
+  store i32 %x, i32* %x.addr, align 4
+  store i32 %y, i32* %y.addr, align 4
+  %0 = load i32, i32* %x.addr, align 4
+  %mul = mul nsw i32 %0, 31
+  %1 = load i32, i32* %y.addr, align 4
+  %add = add nsw i32 %mul, %1
+  %and = and i32 %add, 1023
+  ret i32 %and
+}
+
+; Function Attrs: noinline nounwind readonly uwtable
+define dso_local i32 @lookup(i32 %i) #2 {
+entry:
+  %i.addr = alloca i32, align 4
+  store i32 %i, i32* %i.addr, align 4
+  %0 = load i32, i32* %i.addr, align 4
+  %and = and i32 %0, 255
+  %idxprom = sext i32 %and to i64
+  %arrayidx = getelementptr inbounds [256 x i32], [256 x i32]* @table, i64 0, i64 %idxprom
+  %1 = load i32, i32* %arrayidx, align 4
+  ret i32 %1
+}
+
+; Function Attrs: noinline nounwind uwtable
+define dso_local i64 @kernel(i32 %n) #0 {
+entry:
+  %n.addr = alloca i32, align 4
+  %s = alloca i64, align 8
+  %i = alloca i32, align 4
+  %k = alloca i32, align 4
+  store i32 %n, i32* %n.addr, align 4
+  store i64 0, i64* %s, align 8
+  store i32 0, i32* %i, align 4
+  br label %for.cond
+
+for.cond:                                         ; preds = %for.inc, %entry
+  %0 = load i32, i32* %i, align 4
+  %1 = load i32, i32* %n.addr, align 4
+  %cmp = icmp slt i32 %0, %1
+  br i1 %cmp, label %for.body, label %for.end
+
+for.body:                                         ; preds = %for.cond
+  %2 = load i32, i32* %i, align 4
+  %and = and i32 %2, 255
+  store i32 %and, i32* %k, align 4
+  %3 = load i32, i32* %k, align 4
+  %call = call i32 @mix(i32 %3, i32 3) #3
+  %4 = load i32, i32* %k, align 4
+  %call1 = call i32 @lookup(i32 %4) #4
+  %add = add nsw i32 %call, %call1
+  %conv = sext i32 %add to i64
+  %5 = load i64, i64* %s, align 8
+  %add2 = add nsw i64 %5, %conv
+  store i64 %add2, i64* %s, align 8
+  %6 = load i32, i32* %k, align 4
+  %call3 = call i32 @mix(i32 %6, i32 3) #3
+  %7 = load i32, i32* %k, align 4
+  %call4 = call i32 @lookup(i32 %7) #4
+  %mul = mul nsw i32 %call3, %call4
+  %conv5 = sext i32 %mul to i64
+  %8 = load i64, i64* %s, align 8
+  %add6 = add nsw i64 %8, %conv5
+  store i64 %add6, i64* %s, align 8
+  %9 = load i64, i64* %s, align 8
+  %and7 = and i64 %9, 127
+  %conv8 = trunc i64 %and7 to i32
+  %10 = load i32, i32* %k, align 4
+  %idxprom = sext i32 %10 to i64
+  %arrayidx = getelementptr inbounds [256 x i32], [256 x i32]* @table, i64 0, i64 %idxprom
+  store i32 %conv8, i32* %arrayidx, align 4
+  %11 = load i32, i32* %k, align 4
+  %call9 = call i32 @lookup(i32 %11) #4
+  %conv10 = sext i32 %call9 to i64
+  %12 = load i64, i64* %s, align 8
+  %add11 = add nsw i64 %12, %conv10
+  store i64 %add11, i64* %s, align 8
+  br label %for.inc
+
+for.inc:                                          ; preds = %for.body
+  %13 = load i32, i32* %i, align 4
+  %inc = add nsw i32 %13, 1
+  store i32 %inc, i32* %i, align 4
+  br label %for.cond, !llvm.loop !2
+
+for.end:                                          ; preds = %for.cond
+  %14 = load i64, i64* %s, align 8
+  ret i64 %14
+}
+
+attributes #0 = { noinline nounwind uwtable "disable-tail-calls"="false" "frame-pointer"="all" "less-precise-fpmad"="false" "min-legal-vector-width"="0" "no-infs-fp-math"="false" "no-jump-tables"="false" "no-nans-fp-math"="false" "no-signed-zeros-fp-math"="false" "no-trapping-math"="true" "stack-protector-buffer-size"="8" "target-cpu"="x86-64" "target-features"="+cx8,+fxsr,+mmx,+sse,+sse2,+x87" "tune-cpu"="generic" "unsafe-fp-math"="false" "use-soft-float"="false" }
+attributes #1 = { noinline nounwind readnone uwtable "disable-tail-calls"="false" "frame-pointer"="all" "less-precise-fpmad"="false" "min-legal-vector-width"="0" "no-infs-fp-math"="false" "no-jump-tables"="false" "no-nans-fp-math"="false" "no-signed-zeros-fp-math"="false" "no-trapping-math"="true" "stack-protector-buffer-size"="8" "target-cpu"="x86-64" "target-features"="+cx8,+fxsr,+mmx,+sse,+sse2,+x87" "tune-cpu"="generic" "unsafe-fp-math"="false" "use-soft-float"="false" }
+attributes #2 = { noinline nounwind readonly uwtable "disable-tail-calls"="false" "frame-pointer"="all" "less-precise-fpmad"="false" "min-legal-vector-width"="0" "no-infs-fp-math"="false" "no-jump-tables"="false" "no-nans-fp-math"="false" "no-signed-zeros-fp-math"="false" "no-trapping-math"="true" "stack-protector-buffer-size"="8" "target-cpu"="x86-64" "target-features"="+cx8,+fxsr,+mmx,+sse,+sse2,+x87" "tune-cpu"="generic" "unsafe-fp-math"="false" "use-soft-float"="false" }
+attributes #3 = { nounwind readnone }
+attributes #4 = { nounwind readonly }
+
+!llvm.module.flags = !{!0}
+!llvm.ident = !{!1}
+
+!0 = !{i32 1, !"wchar_size", i32 4}
+!1 = !{!"clang version 12.0.1"}
+!2 = distinct !{!2, !3}
+!3 = !{!"llvm.loop.mustprogress"}
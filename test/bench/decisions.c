@@ -0,0 +1,22 @@
+/* conditions are tested again inside the branches that already decided them */
+long kernel(int n)
+{
+  long s = 0;
+  int i, x, y;
+  for (i = 0; i < n; i++) {
+    x = i & 1023;
+    y = (i >> 2) & 1023;
+    if (x > y) {
+      if (y < x)
+        s += x - y;
+      if (x <= y)
+        s -= 1;
+    } else {
+      if (x > y)
+        s += 7;
+      else
+        s += y - x;
+    }
+  }
+  return s;
+}
@@ -0,0 +1,116 @@
+; ModuleID = 'decisions.c'
+source_filename = "decisions.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; Function Attrs: noinline nounwind uwtable
+define dso_local i64 @kernel(i32 %n) #0 {
+entry:
+  %n.addr = alloca i32, align 4
+  %s = alloca i64, align 8
+  %i = alloca i32, align 4
+  %x = alloca i32, align 4
+  %y = alloca i32, align 4
+  store i32 %n, i32* %n.addr, align 4
+  store i64 0, i64* %s, align 8
+  store i32 0, i32* %i, align 4
+  br label %for.cond
+
+for.cond:                                         ; preds = %for.inc, %entry
+  %0 = load i32, i32* %i, align 4
+  %1 = load i32, i32* %n.addr, align 4
+  %cmp = icmp slt i32 %0, %1
+  br i1 %cmp, label %for.body, label %for.end
+
+for.body:                                         ; preds = %for.cond
+  %2 = load i32, i32* %i, align 4
+  %and = and i32 %2, 1023
+  store i32 %and, i32* %x, align 4
+  %3 = load i32, i32* %i, align 4
+  %shr = ashr i32 %3, 2
+  %and1 = and i32 %shr, 1023
+  store i32 %and1, i32* %y, align 4
+  %4 = load i32, i32* %x, align 4
+  %5 = load i32, i32* %y, align 4
+  %cmp2 = icmp sgt i32 %4, %5
+  br i1 %cmp2, label %if.then, label %if.else
+
+if.then:                                          ; preds = %for.body
+  %6 = load i32, i32* %y, align 4
+  %7 = load i32, i32* %x, align 4
+  %cmp3 = icmp slt i32 %6, %7
+  br i1 %cmp3, label %if.then4, label %if.end
+
+if.then4:                                         ; preds = %if.then
+  %8 = load i32, i32* %x, align 4
+  %9 = load i32, i32* %y, align 4
+  %sub = sub nsw i32 %8, %9
+  %conv = sext i32 %sub to i64
+  %10 = load i64, i64* %s, align 8
+  %add = add nsw i64 %10, %conv
+  store i64 %add, i64* %s, align 8
+  br label %if.end
+
+if.end:                                           ; preds = %if.then4, %if.then
+  %11 = load i32, i32* %x, align 4
+  %12 = load i32, i32* %y, align 4
+  %cmp5 = icmp sle i32 %11, %12
+  br i1 %cmp5, label %if.then7, label %if.end8
+
+if.then7:                                         ; preds = %if.end
+  %13 = load i64, i64* %s, align 8
+  %sub6 = sub nsw i64 %13, 1
+  store i64 %sub6, i64* %s, align 8
+  br label %if.end8
+
+if.end8:                                          ; preds = %if.then7, %if.end
+  br label %if.end17
+
+if.else:                                          ; preds = %for.body
+  %14 = load i32, i32* %x, align 4
+  %15 = load i32, i32* %y, align 4
+  %cmp9 = icmp sgt i32 %14, %15
+  br i1 %cmp9, label %if.then11, label %if.else13
+
+if.then11:                                        ; preds = %if.else
+  %16 = load i64, i64* %s, align 8
+  %add12 = add nsw i64 %16, 7
+  store i64 %add12, i64* %s, align 8
+  br label %if.end16
+
+if.else13:                                        ; preds = %if.else
+  %17 = load i32, i32* %y, align 4
+  %18 = load i32, i32* %x, align 4
+  %sub14 = sub nsw i32 %17, %18
+  %conv15 = sext i32 %sub14 to i64
+  %19 = load i64, i64* %s, align 8
+  %add10 = add nsw i64 %19, %conv15
+  store i64 %add10, i64* %s, align 8
+  br label %if.end16
+
+if.end16:                                         ; preds = %if.else13, %if.then11
+  br label %if.end17
+
+if.end17:                                         ; preds = %if.end16, %if.end8
+  br label %for.inc
+
+for.inc:                                          ; preds = %if.end17
+  %20 = load i32, i32* %i, align 4
+  %inc = add nsw i32 %20, 1
+  store i32 %inc, i32* %i, align 4
+  br label %for.cond, !llvm.loop !2
+
+for.end:                                          ; preds = %for.cond
+  %21 = load i64, i64* %s, align 8
+  ret i64 %21
+}
+
+attributes #0 = { noinline nounwind uwtable "disable-tail-calls"="false" "frame-pointer"="all" "less-precise-fpmad"="false" "min-legal-vector-width"="0" "no-infs-fp-math"="false" "no-jump-tables"="false" "no-nans-fp-math"="false" "no-signed-zeros-fp-math"="false" "no-trapping-math"="true" "stack-protector-buffer-size"="8" "target-cpu"="x86-64" "target-features"="+cx8,+fxsr,+mmx,+sse,+sse2,+x87" "tune-cpu"="generic" "unsafe-fp-math"="false" "use-soft-float"="false" }
+
+!llvm.module.flags = !{!0}
+!llvm.ident = !{!1}
+
+!0 = !{i32 1, !"wchar_size", i32 4}
+!1 = !{!"clang version 12.0.1"}
+!2 = distinct !{!2, !3}
+!3 = !{!"llvm.loop.mustprogress"}
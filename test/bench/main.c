@@ -0,0 +1,67 @@
+/* Timing harness linked with one kernel:
+     ./bench <n> <repetitions>
+   calls kernel(n) repeatedly and prints the sum of the results, the
+   fastest call in seconds and the user-space instructions of that call
+   (-1 where perf_event_open is not available). */
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+long kernel(int n);
+
+static int open_counter(void)
+{
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char** argv)
+{
+  int n = argc > 1 ? atoi(argv[1]) : 1000000;
+  int repetitions = argc > 2 ? atoi(argv[2]) : 5;
+  int counter = open_counter();
+
+  long checksum = 0;
+  double best = -1;
+  long long best_instructions = -1;
+  for (int r = 0; r < repetitions; r++) {
+    long long instructions = -1;
+    if (counter >= 0) {
+      ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+      ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    double start = now();
+    checksum += kernel(n);
+    double elapsed = now() - start;
+    if (counter >= 0) {
+      ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(counter, &instructions, sizeof(instructions)) != sizeof(instructions))
+        instructions = -1;
+    }
+    if (best < 0 || elapsed < best) {
+      best = elapsed;
+      best_instructions = instructions;
+    }
+  }
+  printf("checksum %ld seconds %.6f instructions %lld\n", checksum, best, best_instructions);
+  return 0;
+}
@@ -0,0 +1,15 @@
+/* a * b is computed three times per iteration, the third time only on
+   one side of a branch */
+long kernel(int n)
+{
+  long s = 0;
+  int i, a, b;
+  for (i = 0; i < n; i++) {
+    a = (i & 1023) * 3 + 1;
+    b = (i ^ 5) & 4095;
+    s = s + a * b + (a * b) % 7;
+    if (a > b)
+      s = s - a * b;
+  }
+  return s;
+}
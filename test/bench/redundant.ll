@@ -0,0 +1,85 @@
+; ModuleID = 'redundant.c'
+source_filename = "redundant.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; Function Attrs: noinline nounwind uwtable
+define dso_local i64 @kernel(i32 %n) #0 {
+entry:
+  %n.addr = alloca i32, align 4
+  %s = alloca i64, align 8
+  %i = alloca i32, align 4
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  store i32 %n, i32* %n.addr, align 4
+  store i64 0, i64* %s, align 8
+  store i32 0, i32* %i, align 4
+  br label %for.cond
+
+for.cond:                                         ; preds = %for.inc, %entry
+  %0 = load i32, i32* %i, align 4
+  %1 = load i32, i32* %n.addr, align 4
+  %cmp = icmp slt i32 %0, %1
+  br i1 %cmp, label %for.body, label %for.end
+
+for.body:                                         ; preds = %for.cond
+  %2 = load i32, i32* %i, align 4
+  %and = and i32 %2, 1023
+  %mul = mul nsw i32 %and, 3
+  %add = add nsw i32 %mul, 1
+  store i32 %add, i32* %a, align 4
+  %3 = load i32, i32* %i, align 4
+  %xor = xor i32 %3, 5
+  %and1 = and i32 %xor, 4095
+  store i32 %and1, i32* %b, align 4
+  %4 = load i64, i64* %s, align 8
+  %5 = load i32, i32* %a, align 4
+  %6 = load i32, i32* %b, align 4
+  %mul2 = mul nsw i32 %5, %6
+  %conv = sext i32 %mul2 to i64
+  %add3 = add nsw i64 %4, %conv
+  %7 = load i32, i32* %a, align 4
+  %8 = load i32, i32* %b, align 4
+  %mul4 = mul nsw i32 %7, %8
+  %rem = srem i32 %mul4, 7
+  %conv5 = sext i32 %rem to i64
+  %add6 = add nsw i64 %add3, %conv5
+  store i64 %add6, i64* %s, align 8
+  %9 = load i32, i32* %a, align 4
+  %10 = load i32, i32* %b, align 4
+  %cmp7 = icmp sgt i32 %9, %10
+  br i1 %cmp7, label %if.then, label %if.end
+
+if.then:                                          ; preds = %for.body
+  %11 = load i64, i64* %s, align 8
+  %12 = load i32, i32* %a, align 4
+  %13 = load i32, i32* %b, align 4
+  %mul9 = mul nsw i32 %12, %13
+  %conv10 = sext i32 %mul9 to i64
+  %sub = sub nsw i64 %11, %conv10
+  store i64 %sub, i64* %s, align 8
+  br label %if.end
+
+if.end:                                           ; preds = %if.then, %for.body
+  br label %for.inc
+
+for.inc:                                          ; preds = %if.end
+  %14 = load i32, i32* %i, align 4
+  %inc = add nsw i32 %14, 1
+  store i32 %inc, i32* %i, align 4
+  br label %for.cond, !llvm.loop !2
+
+for.end:                                          ; preds = %for.cond
+  %15 = load i64, i64* %s, align 8
+  ret i64 %15
+}
+
+attributes #0 = { noinline nounwind uwtable "disable-tail-calls"="false" "frame-pointer"="all" "less-precise-fpmad"="false" "min-legal-vector-width"="0" "no-infs-fp-math"="false" "no-jump-tables"="false" "no-nans-fp-math"="false" "no-signed-zeros-fp-math"="false" "no-trapping-math"="true" "stack-protector-buffer-size"="8" "target-cpu"="x86-64" "target-features"="+cx8,+fxsr,+mmx,+sse,+sse2,+x87" "tune-cpu"="generic" "unsafe-fp-math"="false" "use-soft-float"="false" }
+
+!llvm.module.flags = !{!0}
+!llvm.ident = !{!1}
+
+!0 = !{i32 1, !"wchar_size", i32 4}
+!1 = !{!"clang version 12.0.1"}
+!2 = distinct !{!2, !3}
+!3 = !{!"llvm.loop.mustprogress"}
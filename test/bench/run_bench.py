@@ -0,0 +1,123 @@
+import argparse, json, os, subprocess, sys, tempfile
+# Runtime effect of CSElimination.
+#
+#   python3 run_bench.py --build <pass build dir> [--llc-opt -O0]
+#
+# Every kernel (K.c, compiled to K.ll by create_input.sh) is run through
+# each CSElimination variant, compiled with llc, linked with main.c and
+# executed. The table gives the fastest call, the speedup over the
+# unoptimised kernel, the instructions of that call (when perf_event_open
+# is available) and whether the pass changed the IR at all; a speedup of a
+# variant that did not is noise. A variant that changes the result of a
+# kernel is reported as WRONG and makes the script fail.
+#
+# llc runs at -O0 by default so its own CSE does not hide the effect of
+# the pass; --llc-opt=-O2 shows what is left after the backend.
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+# kernel -> n, sized for roughly a tenth of a second unoptimised
+KERNELS = [
+    ("redundant", 50000000),
+    ("stencil", 10000),
+    ("arrays", 20000),
+    ("branches", 50000000),
+    ("decisions", 50000000),
+    ("calls", 20000000),
+]
+
+# variant -> CSElimination flags, None for the kernel as clang wrote it
+VARIANTS = [
+    ("base", None),
+    ("cse", []),
+    ("cse-copy-prop", ["-cse-copy-prop"]),
+    ("cse-pre", ["-cse-pre"]),
+    ("cse-copy-prop-pre", ["-cse-copy-prop", "-cse-pre"]),
+    ("cse-pre-canonical", ["-cse-pre", "-cse-canonical"]),
+    ("cse-pre-loads", ["-cse-pre", "-cse-match-loads"]),
+    ("cse-pre-compares", ["-cse-pre", "-cse-match-loads", "-cse-compares"]),
+    ("cse-pre-addresses", ["-cse-pre", "-cse-match-loads", "-cse-addresses"]),
+    ("cse-pre-calls", ["-cse-pre", "-cse-match-loads", "-cse-pure-calls"]),
+]
+
+
+def build(args, kernel, flags, workdir):
+    """(executable, IR text) of kernel after the pass with flags; the base
+    kernel also goes through opt so the IR texts compare"""
+    name = os.path.join(workdir, kernel + "." + str(len(os.listdir(workdir))))
+    passes = []
+    if flags is not None:
+        library = os.path.join(args.build, "CSElimination", "libCSElimination.so")
+        passes = ["-load", library, "-CSElimination"] + flags
+    subprocess.check_call([args.opt, "-enable-new-pm=0"] + passes +
+                          [os.path.join(HERE, kernel + ".ll"), "-S", "-o", name + ".ll"],
+                          stderr=subprocess.DEVNULL)
+    subprocess.check_call([args.llc, args.llc_opt, "-relocation-model=pic", name + ".ll", "-o", name + ".s"])
+    subprocess.check_call([args.cc, os.path.join(HERE, "main.c"), name + ".s", "-o", name])
+    with open(name + ".ll") as f:
+        return name, f.read()
+
+
+def run(args, executable, n):
+    out = subprocess.check_output([executable, str(n), str(args.repetitions)], universal_newlines=True).split()
+    fields = dict(zip(out[0::2], out[1::2]))
+    instructions = int(fields["instructions"])
+    return {"checksum": int(fields["checksum"]), "seconds": float(fields["seconds"]),
+            "instructions": instructions if instructions >= 0 else None}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="runtime effect of CSElimination")
+    parser.add_argument("--build", required=True, help="build directory of the passes")
+    parser.add_argument("--opt", default="opt")
+    parser.add_argument("--llc", default="llc")
+    parser.add_argument("--llc-opt", default="-O0")
+    parser.add_argument("--cc", default="cc", help="C compiler assembling and linking the harness")
+    parser.add_argument("--repetitions", type=int, default=10)
+    parser.add_argument("--filter", default="", help="only kernels whose name contains this")
+    parser.add_argument("--json", default="", help="also write the results to this file")
+    args = parser.parse_args()
+
+    results = {}
+    wrong = 0
+    print("%-12s %-18s %10s %8s %14s %8s %8s" %
+          ("kernel", "variant", "seconds", "speedup", "instructions", "ratio", "changed"))
+    with tempfile.TemporaryDirectory() as workdir:
+        for kernel, n in KERNELS:
+            if args.filter and args.filter not in kernel:
+                continue
+            base = None
+            for variant, flags in VARIANTS:
+                executable, ir = build(args, kernel, flags, workdir)
+                result = run(args, executable, n)
+                if base is None:
+                    base, base_ir = result, ir
+                result["changed"] = ir != base_ir
+                results[kernel + "/" + variant] = result
+
+                speedup = base["seconds"] / result["seconds"] if result["seconds"] > 0 else 0
+                ratio = "-"
+                if result["instructions"] and base["instructions"]:
+                    ratio = "%.3f" % (result["instructions"] / float(base["instructions"]))
+                status = ""
+                if result["checksum"] != base["checksum"]:
+                    status = "  WRONG (checksum %d, expected %d)" % (result["checksum"], base["checksum"])
+                    wrong += 1
+                print("%-12s %-18s %10.4f %7.2fx %14s %8s %8s%s" %
+                      (kernel, variant, result["seconds"], speedup,
+                       result["instructions"] if result["instructions"] is not None else "-", ratio,
+                       "yes" if result["changed"] else "no", status))
+                sys.stdout.flush()
+
+    if args.json:
+        with open(args.json, "w") as out:
+            json.dump(results, out, indent=1, sort_keys=True)
+            out.write("\n")
+    if wrong:
+        print("%d variants changed the result of a kernel" % wrong)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,15 @@
+/* neighbour averages over a global array; the index arithmetic and r + j
+   are recomputed for every access */
+int buf[1024];
+
+long kernel(int n)
+{
+  long s = 0;
+  int r, j;
+  for (r = 0; r < n; r++) {
+    for (j = 1; j < 1023; j++)
+      buf[j] = (buf[j - 1] + buf[j + 1]) / 2 + ((r + j) * (r + j)) % 64;
+    s += buf[512];
+  }
+  return s;
+}
@@ -0,0 +1,97 @@
+; ModuleID = 'stencil.c'
+source_filename = "stencil.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@buf = dso_local global [1024 x i32] zeroinitializer, align 16
+
+; Function Attrs: noinline nounwind uwtable
+define dso_local i64 @kernel(i32 %n) #0 {
+entry:
+  %n.addr = alloca i32, align 4
+  %s = alloca i64, align 8
+  %r = alloca i32, align 4
+  %j = alloca i32, align 4
+  store i32 %n, i32* %n.addr, align 4
+  store i64 0, i64* %s, align 8
+  store i32 0, i32* %r, align 4
+  br label %for.cond
+
+for.cond:                                         ; preds = %for.inc13, %entry
+  %0 = load i32, i32* %r, align 4
+  %1 = load i32, i32* %n.addr, align 4
+  %cmp = icmp slt i32 %0, %1
+  br i1 %cmp, label %for.body, label %for.end15
+
+for.body:                                         ; preds = %for.cond
+  store i32 1, i32* %j, align 4
+  br label %for.cond1
+
+for.cond1:                                        ; preds = %for.inc, %for.body
+  %2 = load i32, i32* %j, align 4
+  %cmp2 = icmp slt i32 %2, 1023
+  br i1 %cmp2, label %for.body3, label %for.end
+
+for.body3:                                        ; preds = %for.cond1
+  %3 = load i32, i32* %j, align 4
+  %sub = sub nsw i32 %3, 1
+  %idxprom = sext i32 %sub to i64
+  %arrayidx = getelementptr inbounds [1024 x i32], [1024 x i32]* @buf, i64 0, i64 %idxprom
+  %4 = load i32, i32* %arrayidx, align 4
+  %5 = load i32, i32* %j, align 4
+  %add = add nsw i32 %5, 1
+  %idxprom4 = sext i32 %add to i64
+  %arrayidx5 = getelementptr inbounds [1024 x i32], [1024 x i32]* @buf, i64 0, i64 %idxprom4
+  %6 = load i32, i32* %arrayidx5, align 4
+  %add6 = add nsw i32 %4, %6
+  %div = sdiv i32 %add6, 2
+  %7 = load i32, i32* %r, align 4
+  %8 = load i32, i32* %j, align 4
+  %add7 = add nsw i32 %7, %8
+  %9 = load i32, i32* %r, align 4
+  %10 = load i32, i32* %j, align 4
+  %add8 = add nsw i32 %9, %10
+  %mul = mul nsw i32 %add7, %add8
+  %rem = srem i32 %mul, 64
+  %add9 = add nsw i32 %div, %rem
+  %11 = load i32, i32* %j, align 4
+  %idxprom10 = sext i32 %11 to i64
+  %arrayidx11 = getelementptr inbounds [1024 x i32], [1024 x i32]* @buf, i64 0, i64 %idxprom10
+  store i32 %add9, i32* %arrayidx11, align 4
+  br label %for.inc
+
+for.inc:                                          ; preds = %for.body3
+  %12 = load i32, i32* %j, align 4
+  %inc = add nsw i32 %12, 1
+  store i32 %inc, i32* %j, align 4
+  br label %for.cond1, !llvm.loop !2
+
+for.end:                                          ; preds = %for.cond1
+  %13 = load i32, i32* getelementptr inbounds ([1024 x i32], [1024 x i32]* @buf, i64 0, i64 512), align 16
+  %conv = sext i32 %13 to i64
+  %14 = load i64, i64* %s, align 8
+  %add12 = add nsw i64 %14, %conv
+  store i64 %add12, i64* %s, align 8
+  br label %for.inc13
+
+for.inc13:                                        ; preds = %for.end
+  %15 = load i32, i32* %r, align 4
+  %inc14 = add nsw i32 %15, 1
+  store i32 %inc14, i32* %r, align 4
+  br label %for.cond, !llvm.loop !4
+
+for.end15:                                        ; preds = %for.cond
+  %16 = load i64, i64* %s, align 8
+  ret i64 %16
+}
+
+attributes #0 = { noinline nounwind uwtable "disable-tail-calls"="false" "frame-pointer"="all" "less-precise-fpmad"="false" "min-legal-vector-width"="0" "no-infs-fp-math"="false" "no-jump-tables"="false" "no-nans-fp-math"="false" "no-signed-zeros-fp-math"="false" "no-trapping-math"="true" "stack-protector-buffer-size"="8" "target-cpu"="x86-64" "target-features"="+cx8,+fxsr,+mmx,+sse,+sse2,+x87" "tune-cpu"="generic" "unsafe-fp-math"="false" "use-soft-float"="false" }
+
+!llvm.module.flags = !{!0}
+!llvm.ident = !{!1}
+
+!0 = !{i32 1, !"wchar_size", i32 4}
+!1 = !{!"clang version 12.0.1"}
+!2 = distinct !{!2, !3}
+!3 = !{!"llvm.loop.mustprogress"}
+!4 = distinct !{!4, !3}
@@ -0,0 +1,14 @@
+int test(int n) {
+  int a, b, c, s;
+  a = 4;
+  b = a * 2;
+  if (b > 5)
+    c = b + 1;
+  else
+    c = n;
+  if (n < 500)
+    s = c + a;
+  else
+    s = c - n;
+  return s + c;
+}
@@ -0,0 +1,67 @@
+; ModuleID = '1.c'
+source_filename = "1.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; Function Attrs: noinline nounwind uwtable
+define dso_local i32 @test(i32 %n) #0 {
+entry:
+  %n.addr = alloca i32, align 4
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  %c = alloca i32, align 4
+  %s = alloca i32, align 4
+  store i32 %n, i32* %n.addr, align 4
+  store i32 4, i32* %a, align 4
+  %0 = load i32, i32* %a, align 4
+  %mul = mul nsw i32 %0, 2
+  store i32 %mul, i32* %b, align 4
+  %1 = load i32, i32* %b, align 4
+  %cmp = icmp sgt i32 %1, 5
+  br i1 %cmp, label %if.then, label %if.else
+
+if.then:                                          ; preds = %entry
+  %2 = load i32, i32* %b, align 4
+  %add = add nsw i32 %2, 1
+  store i32 %add, i32* %c, align 4
+  br label %if.end
+
+if.else:                                          ; preds = %entry
+  %3 = load i32, i32* %n.addr, align 4
+  store i32 %3, i32* %c, align 4
+  br label %if.end
+
+if.end:                                           ; preds = %if.else, %if.then
+  %4 = load i32, i32* %n.addr, align 4
+  %cmp1 = icmp slt i32 %4, 500
+  br i1 %cmp1, label %if.then2, label %if.else4
+
+if.then2:                                         ; preds = %if.end
+  %5 = load i32, i32* %c, align 4
+  %6 = load i32, i32* %a, align 4
+  %add3 = add nsw i32 %5, %6
+  store i32 %add3, i32* %s, align 4
+  br label %if.end6
+
+if.else4:                                         ; preds = %if.end
+  %7 = load i32, i32* %c, align 4
+  %8 = load i32, i32* %n.addr, align 4
+  %sub = sub nsw i32 %7, %8
+  store i32 %sub, i32* %s, align 4
+  br label %if.end6
+
+if.end6:                                          ; preds = %if.else4, %if.then2
+  %9 = load i32, i32* %s, align 4
+  %10 = load i32, i32* %c, align 4
+  %add7 = add nsw i32 %9, %10
+  ret i32 %add7
+}
+
+attributes #0 = { noinline nounwind uwtable "frame-pointer"="all" "min-legal-vector-width"="0" "no-trapping-math"="true" "stack-protector-buffer-size"="8" "target-cpu"="x86-64" "target-features"="+cx8,+fxsr,+mmx,+sse,+sse2,+x87" "tune-cpu"="generic" }
+
+!llvm.module.flags = !{!0, !1}
+!llvm.ident = !{!2}
+
+!0 = !{i32 1, !"wchar_size", i32 4}
+!1 = !{i32 7, !"uwtable", i32 1}
+!2 = !{!"clang version 14.0.0"}
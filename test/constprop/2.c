@@ -0,0 +1,11 @@
+int test(int n) {
+  int i, k, s;
+  k = 3;
+  s = 0;
+  for (i = 0; i < 10; i++) {
+    s = s + k * i;
+    if (n & 1)
+      k = 5;
+  }
+  return s + k;
+}
@@ -0,0 +1,65 @@
+; ModuleID = '2.c'
+source_filename = "2.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; Function Attrs: noinline nounwind uwtable
+define dso_local i32 @test(i32 %n) #0 {
+entry:
+  %n.addr = alloca i32, align 4
+  %i = alloca i32, align 4
+  %k = alloca i32, align 4
+  %s = alloca i32, align 4
+  store i32 %n, i32* %n.addr, align 4
+  store i32 3, i32* %k, align 4
+  store i32 0, i32* %s, align 4
+  store i32 0, i32* %i, align 4
+  br label %for.cond
+
+for.cond:                                         ; preds = %for.inc, %entry
+  %0 = load i32, i32* %i, align 4
+  %cmp = icmp slt i32 %0, 10
+  br i1 %cmp, label %for.body, label %for.end
+
+for.body:                                         ; preds = %for.cond
+  %1 = load i32, i32* %s, align 4
+  %2 = load i32, i32* %k, align 4
+  %3 = load i32, i32* %i, align 4
+  %mul = mul nsw i32 %2, %3
+  %add = add nsw i32 %1, %mul
+  store i32 %add, i32* %s, align 4
+  %4 = load i32, i32* %n.addr, align 4
+  %and = and i32 %4, 1
+  %tobool = icmp ne i32 %and, 0
+  br i1 %tobool, label %if.then, label %if.end
+
+if.then:                                          ; preds = %for.body
+  store i32 5, i32* %k, align 4
+  br label %if.end
+
+if.end:                                           ; preds = %if.then, %for.body
+  br label %for.inc
+
+for.inc:                                          ; preds = %if.end
+  %5 = load i32, i32* %i, align 4
+  %inc = add nsw i32 %5, 1
+  store i32 %inc, i32* %i, align 4
+  br label %for.cond, !llvm.loop !3
+
+for.end:                                          ; preds = %for.cond
+  %6 = load i32, i32* %s, align 4
+  %7 = load i32, i32* %k, align 4
+  %add1 = add nsw i32 %6, %7
+  ret i32 %add1
+}
+
+attributes #0 = { noinline nounwind uwtable "frame-pointer"="all" "min-legal-vector-width"="0" "no-trapping-math"="true" "stack-protector-buffer-size"="8" "target-cpu"="x86-64" "target-features"="+cx8,+fxsr,+mmx,+sse,+sse2,+x87" "tune-cpu"="generic" }
+
+!llvm.module.flags = !{!0, !1}
+!llvm.ident = !{!2}
+
+!0 = !{i32 1, !"wchar_size", i32 4}
+!1 = !{i32 7, !"uwtable", i32 1}
+!2 = !{!"clang version 14.0.0"}
+!3 = distinct !{!3, !4}
+!4 = !{!"llvm.loop.mustprogress"}
@@ -0,0 +1,2 @@
+# ../../LLVM/install/bin/opt -S -load ../../Pass/build/libConstantPropagation.so -ConstantPropagation < $1 > $1.out
+../../../../llvm/install/bin/opt -S -load ../../Pass/build/libConstantPropagation.so -ConstantPropagation < $1 > $1.out
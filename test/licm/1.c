@@ -0,0 +1,12 @@
+int test(int n) {
+  int i, j, t, k, s;
+  k = n + 1;
+  t = 0;
+  s = 0;
+  for (i = 0; i < 10; i++) {
+    for (j = 0; j < 5; j++)
+      t = t + j;
+    s = s + t * (k * 2);
+  }
+  return s;
+}
@@ -0,0 +1,86 @@
+; ModuleID = '2.c'
+source_filename = "2.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; Function Attrs: noinline nounwind uwtable
+define dso_local i32 @test(i32 %n) #0 {
+entry:
+  %n.addr = alloca i32, align 4
+  %i = alloca i32, align 4
+  %j = alloca i32, align 4
+  %t = alloca i32, align 4
+  %k = alloca i32, align 4
+  %s = alloca i32, align 4
+  store i32 %n, i32* %n.addr, align 4
+  %0 = load i32, i32* %n.addr, align 4
+  %add = add nsw i32 %0, 1
+  store i32 %add, i32* %k, align 4
+  %1 = load i32, i32* %n.addr, align 4
+  %and = and i32 %1, 7
+  store i32 %and, i32* %t, align 4
+  store i32 0, i32* %s, align 4
+  store i32 0, i32* %i, align 4
+  br label %for.cond
+
+for.cond:                                         ; preds = %for.inc8, %entry
+  %2 = load i32, i32* %i, align 4
+  %cmp = icmp slt i32 %2, 10
+  br i1 %cmp, label %for.body, label %for.end10
+
+for.body:                                         ; preds = %for.cond
+  store i32 0, i32* %j, align 4
+  br label %for.cond1
+
+for.cond1:                                        ; preds = %for.inc, %for.body
+  %3 = load i32, i32* %j, align 4
+  %cmp2 = icmp slt i32 %3, 5
+  br i1 %cmp2, label %for.body3, label %for.end
+
+for.body3:                                        ; preds = %for.cond1
+  %4 = load i32, i32* %s, align 4
+  %5 = load i32, i32* %j, align 4
+  %6 = load i32, i32* %k, align 4
+  %mul = mul nsw i32 %5, %6
+  %add4 = add nsw i32 %4, %mul
+  store i32 %add4, i32* %s, align 4
+  br label %for.inc
+
+for.inc:                                          ; preds = %for.body3
+  %7 = load i32, i32* %j, align 4
+  %inc = add nsw i32 %7, 1
+  store i32 %inc, i32* %j, align 4
+  br label %for.cond1, !llvm.loop !3
+
+for.end:                                          ; preds = %for.cond1
+  %8 = load i32, i32* %s, align 4
+  %9 = load i32, i32* %t, align 4
+  %10 = load i32, i32* %k, align 4
+  %mul5 = mul nsw i32 %10, 2
+  %mul6 = mul nsw i32 %9, %mul5
+  %add7 = add nsw i32 %8, %mul6
+  store i32 %add7, i32* %s, align 4
+  br label %for.inc8
+
+for.inc8:                                         ; preds = %for.end
+  %11 = load i32, i32* %i, align 4
+  %inc9 = add nsw i32 %11, 1
+  store i32 %inc9, i32* %i, align 4
+  br label %for.cond, !llvm.loop !5
+
+for.end10:                                        ; preds = %for.cond
+  %12 = load i32, i32* %s, align 4
+  ret i32 %12
+}
+
+attributes #0 = { noinline nounwind uwtable "frame-pointer"="all" "min-legal-vector-width"="0" "no-trapping-math"="true" "stack-protector-buffer-size"="8" "target-cpu"="x86-64" "target-features"="+cx8,+fxsr,+mmx,+sse,+sse2,+x87" "tune-cpu"="generic" }
+
+!llvm.module.flags = !{!0, !1}
+!llvm.ident = !{!2}
+
+!0 = !{i32 1, !"wchar_size", i32 4}
+!1 = !{i32 7, !"uwtable", i32 1}
+!2 = !{!"clang version 14.0.0"}
+!3 = distinct !{!3, !4}
+!4 = !{!"llvm.loop.mustprogress"}
+!5 = distinct !{!5, !4}
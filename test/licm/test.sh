@@ -0,0 +1,2 @@
+# ../../LLVM/install/bin/opt -S -load ../../Pass/build/libLoopInvariantCodeMotion.so -LoopInvariantCodeMotion < $1 > $1.out
+../../../../llvm/install/bin/opt -S -load ../../Pass/build/libLoopInvariantCodeMotion.so -LoopInvariantCodeMotion < $1 > $1.out
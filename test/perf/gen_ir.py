@@ -0,0 +1,26 @@
+import sys, random
+# Generate an -O0 style function for the performance corpus:
+#   python3 gen_ir.py V B > out.ll
+# V locals (allocas) and B blocks of four load/load/add/store groups, ending
+# in a conditional branch to the next block or, 30% of the time, back to an
+# earlier one. The seed is fixed so the same V B always gives the same IR.
+V = int(sys.argv[1]); B = int(sys.argv[2]); random.seed(1)
+print("define i32 @big(i32 %n) {")
+print("entry:")
+for v in range(V): print(f"  %v{v} = alloca i32")
+for v in range(V): print(f"  store i32 {v}, i32* %v{v}")
+print("  br label %b0")
+t = 0
+for b in range(B):
+    print(f"b{b}:")
+    for k in range(4):
+        a = random.randrange(V); c = random.randrange(V); d = random.randrange(V)
+        print(f"  %t{t} = load i32, i32* %v{a}"); print(f"  %t{t+1} = load i32, i32* %v{c}")
+        print(f"  %t{t+2} = add i32 %t{t}, %t{t+1}"); print(f"  store i32 %t{t+2}, i32* %v{d}")
+        t += 3
+    print(f"  %c{b} = icmp slt i32 %t{t-1}, %n")
+    nxt = f"b{b+1}" if b + 1 < B else "exit"
+    other = f"b{random.randrange(b+1)}" if b > 0 and random.random() < 0.3 else nxt
+    print(f"  br i1 %c{b}, label %{nxt}, label %{other}")
+print("exit:")
+print(f"  %r = load i32, i32* %v0\n  ret i32 %r\n}}")
@@ -0,0 +1,263 @@
+import argparse, ctypes, json, os, platform, struct, subprocess, sys, tempfile, time
+# Performance regression check for the passes.
+#
+#   python3 run_perf.py --build <pass build dir> [--opt opt] [--update]
+#   python3 run_perf.py --build <pass build dir> --against <reference build dir>
+#
+# Every pass runs over a fixed corpus (the phase2/phase3 examples and IR
+# from gen_ir.py) --runs times. The fastest wall time, the median number of
+# instructions retired (perf_event_open, when the kernel allows it) and the
+# peak RSS of each case are compared with a reference; the script fails if
+# any of them grew by more than its threshold.
+#
+# The reference is either a baseline recorded by --update on this machine
+# (<build>/perf_baseline.json, refused when it comes from another machine)
+# or, with --against, a second build of the passes measured in the same
+# run, its runs interleaved with ours so both see the same machine load.
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TEST = os.path.dirname(HERE)
+
+# name -> (plugin, pass flag, extra flags)
+PASSES = [
+    ("Hello",                   "HelloPass",               "-Hello",                   []),
+    ("ReachingDefinition",      "ReachingDefinition",      "-ReachingDefinition",      []),
+    ("CSElimination",           "CSElimination",           "-CSElimination",           []),
+    ("CSElimination-pre",       "CSElimination",           "-CSElimination",           ["-cse-pre"]),
+    ("ConstantPropagation",     "ConstantPropagation",     "-ConstantPropagation",     []),
+    ("LoopInvariantCodeMotion", "LoopInvariantCodeMotion", "-LoopInvariantCodeMotion", []),
+    ("StrengthReduction",       "StrengthReduction",       "-StrengthReduction",       []),
+]
+
+# name -> checked-in file, or (V, B) arguments of gen_ir.py
+INPUTS = [
+    ("phase2-1", os.path.join(TEST, "phase2", "1.ll")),
+    ("phase3-1", os.path.join(TEST, "phase3", "1.ll")),
+    ("phase3-2", os.path.join(TEST, "phase3", "2.ll")),
+    ("gen-50x200", (50, 200)),
+    ("gen-100x500", (100, 500)),
+]
+
+# ---------------- instruction counts ----------------
+
+PERF_TYPE_HARDWARE = 0
+PERF_COUNT_HW_INSTRUCTIONS = 1
+SYS_perf_event_open = {"x86_64": 298, "aarch64": 241}.get(platform.machine())
+
+libc = ctypes.CDLL(None, use_errno=True)
+
+
+# why the last counter could not be opened, empty if it could
+counter_error = ""
+
+
+def open_instruction_counter(pid):
+    """Counter of user-space instructions of pid and its children, armed to
+    start at its next exec. None if the kernel or the CPU cannot count."""
+    global counter_error
+    if SYS_perf_event_open is None:
+        counter_error = "no perf_event_open on " + platform.machine()
+        return None
+    attr = bytearray(128)
+    struct.pack_into("IIQ", attr, 0, PERF_TYPE_HARDWARE, len(attr), PERF_COUNT_HW_INSTRUCTIONS)
+    # disabled | inherit | exclude_kernel | exclude_hv | enable_on_exec
+    struct.pack_into("Q", attr, 40, (1 << 0) | (1 << 1) | (1 << 5) | (1 << 6) | (1 << 12))
+    buf = ctypes.create_string_buffer(bytes(attr), len(attr))
+    fd = libc.syscall(SYS_perf_event_open, buf, pid, -1, -1, 0)
+    if fd < 0:
+        counter_error = "perf_event_open: " + os.strerror(ctypes.get_errno())
+        return None
+    return fd
+
+
+def run_once(cmd):
+    """(wall seconds, instructions or None, peak RSS in MB) of one run"""
+    ready_r, ready_w = os.pipe()
+    pid = os.fork()
+    if pid == 0:
+        os.close(ready_w)
+        os.read(ready_r, 1)
+        null = os.open(os.devnull, os.O_RDWR)
+        os.dup2(null, 1)
+        os.dup2(null, 2)
+        try:
+            os.execvp(cmd[0], cmd)
+        finally:
+            os._exit(127)
+
+    os.close(ready_r)
+    counter = open_instruction_counter(pid)
+    start = time.perf_counter()
+    os.write(ready_w, b"x")
+    os.close(ready_w)
+    _, status, usage = os.wait4(pid, 0)
+    elapsed = time.perf_counter() - start
+
+    instructions = None
+    if counter is not None:
+        instructions = struct.unpack("Q", os.read(counter, 8))[0]
+        os.close(counter)
+    if not os.WIFEXITED(status) or os.WEXITSTATUS(status) != 0:
+        raise RuntimeError("failed: " + " ".join(cmd))
+    return elapsed, instructions, usage.ru_maxrss / 1024.0
+
+
+def median(values):
+    values = sorted(values)
+    return values[len(values) // 2]
+
+# ---------------- corpus ----------------
+
+
+def input_files(workdir):
+    files = {}
+    for name, source in INPUTS:
+        if isinstance(source, str):
+            files[name] = source
+            continue
+        path = os.path.join(workdir, name + ".ll")
+        with open(path, "w") as out:
+            subprocess.check_call([sys.executable, os.path.join(HERE, "gen_ir.py")] + [str(a) for a in source],
+                                  stdout=out)
+        files[name] = path
+    return files
+
+
+def summary(runs):
+    instructions = [r[1] for r in runs]
+    return {
+        "time": round(min([r[0] for r in runs]), 4),
+        "instructions": median(instructions) if None not in instructions else None,
+        "rss_mb": round(median([r[2] for r in runs]), 1),
+    }
+
+
+def measure(args, builds):
+    """results of every case for each build directory in builds. The runs of
+    one case alternate between the builds, so a change in machine load hits
+    all of them alike."""
+    results = [{} for _ in builds]
+    with tempfile.TemporaryDirectory() as workdir:
+        files = input_files(workdir)
+        for pass_name, plugin, flag, extra in PASSES:
+            for input_name, _ in INPUTS:
+                case = pass_name + "/" + input_name
+                if args.filter and args.filter not in case:
+                    continue
+                cmds = [[args.opt, "-enable-new-pm=0", "-load", os.path.join(build, plugin, "lib" + plugin + ".so"),
+                         flag] + extra + [files[input_name], "-o", os.devnull] for build in builds]
+                runs = [[] for _ in builds]
+                for _ in range(args.runs):
+                    for i, cmd in enumerate(cmds):
+                        runs[i].append(run_once(cmd))
+                line = "%-40s" % case
+                for i in range(len(builds)):
+                    results[i][case] = summary(runs[i])
+                    line += " %8.3fs %8.1f MB" % (results[i][case]["time"], results[i][case]["rss_mb"])
+                print(line)
+                sys.stdout.flush()
+    return results
+
+
+def machine():
+    """what the times of a baseline depend on"""
+    cpu = ""
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.startswith("model name"):
+                    cpu = line.split(":", 1)[1].strip()
+                    break
+    except OSError:
+        pass
+    return {"host": platform.node(), "arch": platform.machine(), "cpu": cpu, "cpus": os.cpu_count()}
+
+# ---------------- comparison ----------------
+
+
+def compare(baseline, results, args):
+    thresholds = {"time": args.time_threshold, "instructions": args.instructions_threshold,
+                  "rss_mb": args.rss_threshold}
+    # smallest growth that counts, so that start up jitter of short cases
+    # does not fail the check while they are still checked
+    min_delta = {"time": args.min_delta, "instructions": 0, "rss_mb": 0}
+    failures = []
+    for case, now in sorted(results.items()):
+        base = baseline.get(case)
+        if base is None:
+            print("%-40s new case, not in the baseline" % case)
+            continue
+        for metric, limit in thresholds.items():
+            old, new = base.get(metric), now.get(metric)
+            if old is None or new is None or old == 0:
+                continue
+            change = (new - old) / float(old)
+            if change > limit and new - old > min_delta[metric]:
+                failures.append(case)
+                print("%-40s %-12s %12s -> %12s  %+.1f%% (limit %.0f%%)" %
+                      (case, metric, old, new, 100 * change, 100 * limit))
+    return failures
+
+
+def has_instructions(cases):
+    return any(c.get("instructions") is not None for c in cases.values())
+
+
+def main():
+    parser = argparse.ArgumentParser(description="performance regression check for the passes")
+    parser.add_argument("--build", required=True, help="build directory of the passes")
+    parser.add_argument("--opt", default="opt", help="opt binary to load the passes into")
+    parser.add_argument("--baseline", default="",
+                        help="baseline file, by default perf_baseline.json in the build directory")
+    parser.add_argument("--against", default="",
+                        help="build directory of reference passes to measure in the same run instead of a baseline")
+    parser.add_argument("--runs", type=int, default=5)
+    parser.add_argument("--filter", default="", help="only cases whose name contains this")
+    parser.add_argument("--time-threshold", type=float, default=0.15)
+    parser.add_argument("--instructions-threshold", type=float, default=0.03)
+    parser.add_argument("--rss-threshold", type=float, default=0.10)
+    parser.add_argument("--min-delta", type=float, default=0.01,
+                        help="seconds a case must slow down by, on top of --time-threshold, to fail")
+    parser.add_argument("--update", action="store_true", help="write the results as the new baseline")
+    args = parser.parse_args()
+    baseline_path = args.baseline or os.path.join(args.build, "perf_baseline.json")
+
+    if args.against:
+        reference, results = measure(args, [args.against, args.build])
+    else:
+        if not args.update:
+            if not os.path.exists(baseline_path):
+                print("no baseline at %s, run with --update first or use --against" % baseline_path)
+                return 1
+            with open(baseline_path) as f:
+                recorded = json.load(f)
+            if recorded.get("machine") != machine():
+                print("baseline %s was recorded on %s, not on this machine (%s);" %
+                      (baseline_path, recorded.get("machine"), machine()))
+                print("record one here with --update or compare two builds with --against")
+                return 1
+            reference = recorded["cases"]
+        results = measure(args, [args.build])[0]
+
+    if args.update:
+        with open(baseline_path, "w") as out:
+            json.dump({"machine": machine(), "cases": results}, out, indent=1, sort_keys=True)
+            out.write("\n")
+        print("baseline written to " + baseline_path)
+        if not has_instructions(results):
+            print("instruction counts unavailable (%s), the baseline has times and RSS only" % counter_error)
+        return 0
+
+    if not has_instructions(results) or not has_instructions(reference):
+        print("instruction counts unavailable (%s), checking time and RSS only" %
+              (counter_error or "not in the baseline"))
+    failures = compare(reference, results, args)
+    if failures:
+        print("%d performance regressions" % len(set(failures)))
+        return 1
+    print("no performance regressions")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,24 @@
+/* main leaves through exit() in the middle of its loop, so the block that
+   calls exit() ends in unreachable instead of a return */
+#include <stdio.h>
+#include <stdlib.h>
+
+int step(int i)
+{
+  if (i % 3 == 0)
+    return i / 3;
+  return i + 1;
+}
+
+int main(void)
+{
+  int i, s = 0;
+  for (i = 0; i < 100; i++) {
+    s += step(i);
+    if (i == 41) {
+      printf("%d\n", s);
+      exit(0);
+    }
+  }
+  return s & 1;
+}
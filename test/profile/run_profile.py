@@ -0,0 +1,54 @@
+import argparse, glob, os, subprocess, sys, tempfile
+# Round trip of the EdgeProfile pass.
+#
+#   python3 run_profile.py --build <pass build dir>
+#
+# Every program K.ll here is instrumented, compiled with llc, linked with
+# the runtime and run once. The counts it wrote are read back with
+# -edge-profile-use and the printed block frequencies must equal
+# K.expected, which holds the counts known from the source.
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="round trip of the EdgeProfile pass")
+    parser.add_argument("--build", required=True, help="build directory of the passes")
+    parser.add_argument("--opt", default="opt")
+    parser.add_argument("--llc", default="llc")
+    parser.add_argument("--cc", default="cc", help="C compiler assembling and linking the program")
+    args = parser.parse_args()
+
+    library = os.path.join(args.build, "EdgeProfile", "libEdgeProfile.so")
+    runtime = os.path.join(args.build, "EdgeProfile", "libedge_profile_rt.a")
+    failures = 0
+    with tempfile.TemporaryDirectory() as workdir:
+        for path in sorted(glob.glob(os.path.join(HERE, "*.ll"))):
+            name = os.path.splitext(os.path.basename(path))[0]
+            program = os.path.join(workdir, name)
+            profile = os.path.join(workdir, name + ".txt")
+            subprocess.check_call([args.opt, "-enable-new-pm=0", "-load", library, "-EdgeProfile",
+                                   path, "-S", "-o", program + ".ll"], stderr=subprocess.DEVNULL)
+            subprocess.check_call([args.llc, "-relocation-model=pic", program + ".ll", "-o", program + ".s"])
+            subprocess.check_call([args.cc, program + ".s", runtime, "-o", program])
+            subprocess.run([program], stdout=subprocess.DEVNULL, env=dict(os.environ, EDGE_PROFILE_FILE=profile))
+
+            result = subprocess.run([args.opt, "-enable-new-pm=0", "-load", library, "-EdgeProfile",
+                                     "-edge-profile-use=" + profile, "-disable-output", path],
+                                    stderr=subprocess.PIPE, universal_newlines=True)
+            with open(os.path.join(HERE, name + ".expected")) as f:
+                expected = f.read()
+            if result.stderr != expected:
+                failures += 1
+                print("FAIL %s: block frequencies\n%s" % (name, result.stderr))
+            else:
+                print("ok   %s" % name)
+
+    if failures:
+        print("%d programs profiled wrongly" % failures)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,11 @@
+int a[100];
+
+int test(int n) {
+  int i, s;
+  for (i = 0; i < 99; i++)
+    a[i] = i * 3 + n;
+  s = 0;
+  for (i = 98; i > 0; i--)
+    s = s + a[i] * a[i - 1];
+  return s;
+}
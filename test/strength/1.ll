@@ -0,0 +1,87 @@
+; ModuleID = '1.c'
+source_filename = "1.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@a = dso_local global [100 x i32] zeroinitializer, align 16
+
+; Function Attrs: noinline nounwind uwtable
+define dso_local i32 @test(i32 %n) #0 {
+entry:
+  %n.addr = alloca i32, align 4
+  %i = alloca i32, align 4
+  %s = alloca i32, align 4
+  store i32 %n, i32* %n.addr, align 4
+  store i32 0, i32* %i, align 4
+  br label %for.cond
+
+for.cond:                                         ; preds = %for.inc, %entry
+  %0 = load i32, i32* %i, align 4
+  %cmp = icmp slt i32 %0, 99
+  br i1 %cmp, label %for.body, label %for.end
+
+for.body:                                         ; preds = %for.cond
+  %1 = load i32, i32* %i, align 4
+  %mul = mul nsw i32 %1, 3
+  %2 = load i32, i32* %n.addr, align 4
+  %add = add nsw i32 %mul, %2
+  %3 = load i32, i32* %i, align 4
+  %idxprom = sext i32 %3 to i64
+  %arrayidx = getelementptr inbounds [100 x i32], [100 x i32]* @a, i64 0, i64 %idxprom
+  store i32 %add, i32* %arrayidx, align 4
+  br label %for.inc
+
+for.inc:                                          ; preds = %for.body
+  %4 = load i32, i32* %i, align 4
+  %inc = add nsw i32 %4, 1
+  store i32 %inc, i32* %i, align 4
+  br label %for.cond, !llvm.loop !2
+
+for.end:                                          ; preds = %for.cond
+  store i32 0, i32* %s, align 4
+  store i32 98, i32* %i, align 4
+  br label %for.cond1
+
+for.cond1:                                        ; preds = %for.inc8, %for.end
+  %5 = load i32, i32* %i, align 4
+  %cmp2 = icmp sgt i32 %5, 0
+  br i1 %cmp2, label %for.body3, label %for.end9
+
+for.body3:                                        ; preds = %for.cond1
+  %6 = load i32, i32* %s, align 4
+  %7 = load i32, i32* %i, align 4
+  %idxprom4 = sext i32 %7 to i64
+  %arrayidx5 = getelementptr inbounds [100 x i32], [100 x i32]* @a, i64 0, i64 %idxprom4
+  %8 = load i32, i32* %arrayidx5, align 4
+  %9 = load i32, i32* %i, align 4
+  %sub = sub nsw i32 %9, 1
+  %idxprom6 = sext i32 %sub to i64
+  %arrayidx7 = getelementptr inbounds [100 x i32], [100 x i32]* @a, i64 0, i64 %idxprom6
+  %10 = load i32, i32* %arrayidx7, align 4
+  %mul8 = mul nsw i32 %8, %10
+  %add9 = add nsw i32 %6, %mul8
+  store i32 %add9, i32* %s, align 4
+  br label %for.inc8
+
+for.inc8:                                         ; preds = %for.body3
+  %11 = load i32, i32* %i, align 4
+  %dec = add nsw i32 %11, -1
+  store i32 %dec, i32* %i, align 4
+  br label %for.cond1, !llvm.loop !4
+
+for.end9:                                         ; preds = %for.cond1
+  %12 = load i32, i32* %s, align 4
+  ret i32 %12
+}
+
+attributes #0 = { noinline nounwind uwtable "frame-pointer"="all" "min-legal-vector-width"="0" "no-trapping-math"="true" "stack-protector-buffer-size"="8" "target-cpu"="x86-64" "target-features"="+cx8,+fxsr,+mmx,+sse,+sse2,+x87" "tune-cpu"="generic" }
+
+!llvm.module.flags = !{!0, !1}
+!llvm.ident = !{!5}
+
+!0 = !{i32 1, !"wchar_size", i32 4}
+!1 = !{i32 7, !"uwtable", i32 1}
+!2 = distinct !{!2, !3}
+!3 = !{!"llvm.loop.mustprogress"}
+!4 = distinct !{!4, !3}
+!5 = !{!"clang version 14.0.0"}
@@ -0,0 +1,2 @@
+# ../../LLVM/install/bin/opt -S -load ../../Pass/build/libStrengthReduction.so -StrengthReduction < $1 > $1.out
+../../../../llvm/install/bin/opt -S -load ../../Pass/build/libStrengthReduction.so -StrengthReduction < $1 > $1.out
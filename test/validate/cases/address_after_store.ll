@@ -0,0 +1,67 @@
+; int a[8]; ... i = n & 7; s = a[i]; a[i] = 7; s += a[i]; i = (i + 1) & 7;
+; s += a[i]; return s;
+; The address of a[i] is computed again after a store through it, which
+; must not change it, and after a store to i, which must.
+
+define i32 @address_after_store(i32 %n) {
+entry:
+  %n.addr = alloca i32, align 4
+  %a = alloca [8 x i32], align 16
+  %i = alloca i32, align 4
+  %s = alloca i32, align 4
+  store i32 %n, i32* %n.addr, align 4
+  store i32 0, i32* %i, align 4
+  br label %for.cond
+
+for.cond:
+  %0 = load i32, i32* %i, align 4
+  %cmp = icmp slt i32 %0, 8
+  br i1 %cmp, label %for.body, label %for.end
+
+for.body:
+  %1 = load i32, i32* %i, align 4
+  %2 = load i32, i32* %n.addr, align 4
+  %mul = mul nsw i32 %1, %2
+  %3 = load i32, i32* %i, align 4
+  %idxprom = sext i32 %3 to i64
+  %arrayidx = getelementptr inbounds [8 x i32], [8 x i32]* %a, i64 0, i64 %idxprom
+  store i32 %mul, i32* %arrayidx, align 4
+  %4 = load i32, i32* %i, align 4
+  %inc = add nsw i32 %4, 1
+  store i32 %inc, i32* %i, align 4
+  br label %for.cond
+
+for.end:
+  %5 = load i32, i32* %n.addr, align 4
+  %and = and i32 %5, 7
+  store i32 %and, i32* %i, align 4
+  %6 = load i32, i32* %i, align 4
+  %idxprom1 = sext i32 %6 to i64
+  %arrayidx2 = getelementptr inbounds [8 x i32], [8 x i32]* %a, i64 0, i64 %idxprom1
+  %7 = load i32, i32* %arrayidx2, align 4
+  store i32 %7, i32* %s, align 4
+  %8 = load i32, i32* %i, align 4
+  %idxprom3 = sext i32 %8 to i64
+  %arrayidx4 = getelementptr inbounds [8 x i32], [8 x i32]* %a, i64 0, i64 %idxprom3
+  store i32 7, i32* %arrayidx4, align 4
+  %9 = load i32, i32* %i, align 4
+  %idxprom5 = sext i32 %9 to i64
+  %arrayidx6 = getelementptr inbounds [8 x i32], [8 x i32]* %a, i64 0, i64 %idxprom5
+  %10 = load i32, i32* %arrayidx6, align 4
+  %11 = load i32, i32* %s, align 4
+  %add = add nsw i32 %11, %10
+  store i32 %add, i32* %s, align 4
+  %12 = load i32, i32* %i, align 4
+  %add7 = add nsw i32 %12, 1
+  %and8 = and i32 %add7, 7
+  store i32 %and8, i32* %i, align 4
+  %13 = load i32, i32* %i, align 4
+  %idxprom9 = sext i32 %13 to i64
+  %arrayidx10 = getelementptr inbounds [8 x i32], [8 x i32]* %a, i64 0, i64 %idxprom9
+  %14 = load i32, i32* %arrayidx10, align 4
+  %15 = load i32, i32* %s, align 4
+  %add11 = add nsw i32 %15, %14
+  store i32 %add11, i32* %s, align 4
+  %16 = load i32, i32* %s, align 4
+  ret i32 %16
+}
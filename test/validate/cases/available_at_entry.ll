@@ -0,0 +1,47 @@
+; SSA form input for the default scheme: a * b is computed in both arms
+; and again at the join, where it is replaced by a read of the temporary
+; both arms store it in. Not replaced: a product whose nsw flag differs
+; from the one in a predecessor, and one whose definition is in its own
+; block on the previous trip around a loop.
+
+define i32 @available_from_both_arms(i32 %a, i32 %b) {
+entry:
+  %c = icmp slt i32 %a, 500
+  br i1 %c, label %then, label %else
+
+then:
+  %x = mul nsw i32 %a, %b
+  %x1 = add i32 %x, 1
+  br label %join
+
+else:
+  %y = mul nsw i32 %b, %a
+  %y1 = sub i32 %y, 1
+  br label %join
+
+join:
+  %p = phi i32 [ %x1, %then ], [ %y1, %else ]
+  %z = mul nsw i32 %a, %b
+  %w = mul i32 %a, %b
+  %r = add i32 %z, %p
+  %s = add i32 %r, %w
+  ret i32 %s
+}
+
+define i32 @available_around_loop(i32 %a, i32 %b) {
+entry:
+  %m0 = add i32 %a, %b
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i32 [ %m0, %entry ], [ %acc.next, %loop ]
+  %m = add i32 %a, %b
+  %acc.next = add i32 %acc, %m
+  %i.next = add i32 %i, 1
+  %again = icmp slt i32 %i.next, 3
+  br i1 %again, label %loop, label %exit
+
+exit:
+  ret i32 %acc.next
+}
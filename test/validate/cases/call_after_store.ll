@@ -0,0 +1,58 @@
+; int g = 1; int get(void) __attribute__((pure)) { return g; }
+; r = get(); g = n; r += get();  and the same with the first call under
+; if (n < 500). The store to g between the calls must keep the second
+; call, in one block and across the branch.
+
+@g = global i32 1, align 4
+
+define i32 @get() #0 {
+entry:
+  %0 = load i32, i32* @g, align 4
+  ret i32 %0
+}
+
+define i32 @call_after_store(i32 %n) {
+entry:
+  %n.addr = alloca i32, align 4
+  %r = alloca i32, align 4
+  store i32 %n, i32* %n.addr, align 4
+  %call = call i32 @get() #1
+  store i32 %call, i32* %r, align 4
+  %0 = load i32, i32* %n.addr, align 4
+  store i32 %0, i32* @g, align 4
+  %call1 = call i32 @get() #1
+  %1 = load i32, i32* %r, align 4
+  %add = add nsw i32 %1, %call1
+  store i32 %add, i32* %r, align 4
+  %2 = load i32, i32* %r, align 4
+  ret i32 %2
+}
+
+define i32 @call_after_store_in_branch(i32 %n) {
+entry:
+  %n.addr = alloca i32, align 4
+  %r = alloca i32, align 4
+  store i32 %n, i32* %n.addr, align 4
+  store i32 0, i32* %r, align 4
+  %0 = load i32, i32* %n.addr, align 4
+  %cmp = icmp slt i32 %0, 500
+  br i1 %cmp, label %if.then, label %if.end
+
+if.then:
+  %call = call i32 @get() #1
+  store i32 %call, i32* %r, align 4
+  %1 = load i32, i32* %n.addr, align 4
+  store i32 %1, i32* @g, align 4
+  br label %if.end
+
+if.end:
+  %call1 = call i32 @get() #1
+  %2 = load i32, i32* %r, align 4
+  %add = add nsw i32 %2, %call1
+  store i32 %add, i32* %r, align 4
+  %3 = load i32, i32* %r, align 4
+  ret i32 %3
+}
+
+attributes #0 = { noinline nounwind readonly willreturn }
+attributes #1 = { nounwind readonly willreturn }
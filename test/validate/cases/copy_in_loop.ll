@@ -0,0 +1,53 @@
+; z = x only in the first iteration, x changes afterwards: the load of z
+; after the loop must not read x again
+;
+;   int copy_in_first_iteration(int n)
+;   {
+;     int x = 0, z, i = 0;
+;     do {
+;       if (i == 0)
+;         z = x;
+;       x = 2;
+;       i++;
+;     } while (i < n);
+;     return z;
+;   }
+
+define i32 @copy_in_first_iteration(i32 %n) {
+entry:
+  %n.addr = alloca i32, align 4
+  %x = alloca i32, align 4
+  %z = alloca i32, align 4
+  %i = alloca i32, align 4
+  store i32 %n, i32* %n.addr, align 4
+  store i32 0, i32* %x, align 4
+  store i32 0, i32* %i, align 4
+  br label %do.body
+
+do.body:                                          ; preds = %do.cond, %entry
+  %0 = load i32, i32* %i, align 4
+  %cmp = icmp eq i32 %0, 0
+  br i1 %cmp, label %if.then, label %if.end
+
+if.then:                                          ; preds = %do.body
+  %1 = load i32, i32* %x, align 4
+  store i32 %1, i32* %z, align 4
+  br label %if.end
+
+if.end:                                           ; preds = %if.then, %do.body
+  store i32 2, i32* %x, align 4
+  %2 = load i32, i32* %i, align 4
+  %inc = add nsw i32 %2, 1
+  store i32 %inc, i32* %i, align 4
+  br label %do.cond
+
+do.cond:                                          ; preds = %if.end
+  %3 = load i32, i32* %i, align 4
+  %4 = load i32, i32* %n.addr, align 4
+  %cmp1 = icmp slt i32 %3, %4
+  br i1 %cmp1, label %do.body, label %do.end
+
+do.end:                                           ; preds = %do.cond
+  %5 = load i32, i32* %z, align 4
+  ret i32 %5
+}
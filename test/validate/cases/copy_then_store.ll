@@ -0,0 +1,33 @@
+; int z = x; x = 5; then z + 1 under if (c < 500) and after it. Once the copy is
+; forwarded, the loads of z read the old x: matching them as loads of x
+; must not reload x below the store.
+
+define i32 @copy_then_store(i32 %c) {
+entry:
+  %c.addr = alloca i32, align 4
+  %x = alloca i32, align 4
+  %z = alloca i32, align 4
+  %r = alloca i32, align 4
+  store i32 %c, i32* %c.addr, align 4
+  store i32 100, i32* %x, align 4
+  %0 = load i32, i32* %x, align 4
+  store i32 %0, i32* %z, align 4
+  store i32 5, i32* %x, align 4
+  store i32 0, i32* %r, align 4
+  %1 = load i32, i32* %c.addr, align 4
+  %tobool = icmp slt i32 %1, 500
+  br i1 %tobool, label %if.then, label %if.end
+
+if.then:
+  %2 = load i32, i32* %z, align 4
+  %add = add nsw i32 %2, 1
+  store i32 %add, i32* %r, align 4
+  br label %if.end
+
+if.end:
+  %3 = load i32, i32* %z, align 4
+  %add1 = add nsw i32 %3, 1
+  %4 = load i32, i32* %r, align 4
+  %add2 = add nsw i32 %add1, %4
+  ret i32 %add2
+}
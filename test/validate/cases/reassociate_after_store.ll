@@ -0,0 +1,45 @@
+; x = init; do { t = x + 1; if (a & 3) { x = 5; u = t + 2; } v = x + 3; }
+; while (++i < (b & 1));  return v + 0 * u;
+; With -cse-canonical, t + 2 is matched as x + 3 through the load of x in
+; t. After the store x = 5 that is no longer the value of x, so it must
+; not stand for v = x + 3 at the join.
+
+define i32 @reassociate_after_store(i32 %init, i32 %a, i32 %b) {
+entry:
+  %x = alloca i32, align 4
+  %i = alloca i32, align 4
+  %u = alloca i32, align 4
+  store i32 %init, i32* %x, align 4
+  store i32 0, i32* %i, align 4
+  store i32 0, i32* %u, align 4
+  br label %header
+
+header:
+  %l1 = load i32, i32* %x, align 4
+  %t = add i32 %l1, 1
+  %abit = and i32 %a, 3
+  %tobool = icmp ne i32 %abit, 0
+  br i1 %tobool, label %arm, label %join
+
+arm:
+  store i32 5, i32* %x, align 4
+  %u1 = add i32 %t, 2
+  store i32 %u1, i32* %u, align 4
+  br label %join
+
+join:
+  %l3 = load i32, i32* %x, align 4
+  %v = add i32 %l3, 3
+  %l4 = load i32, i32* %i, align 4
+  %inc = add nsw i32 %l4, 1
+  store i32 %inc, i32* %i, align 4
+  %bmask = and i32 %b, 1
+  %again = icmp slt i32 %inc, %bmask
+  br i1 %again, label %header, label %exit
+
+exit:
+  %l5 = load i32, i32* %u, align 4
+  %zero = mul i32 %l5, 0
+  %ret = add i32 %v, %zero
+  ret i32 %ret
+}
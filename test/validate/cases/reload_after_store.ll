@@ -0,0 +1,25 @@
+; A load of x is used in two blocks after x was stored to. Matching the
+; load by the definitions of x that reach it must not make lazy code
+; motion reload x below the store: a + 1 must stay 101, not become 6.
+
+define i32 @reload_after_store(i32 %c) {
+entry:
+  %x = alloca i32, align 4
+  store i32 100, i32* %x, align 4
+  %lx = load i32, i32* %x, align 4
+  store i32 5, i32* %x, align 4
+  %cond = icmp slt i32 %c, 500
+  br i1 %cond, label %a, label %m
+
+a:
+  %s = add i32 %lx, 1
+  %cond2 = icmp sgt i32 %s, %c
+  br i1 %cond2, label %m, label %done
+
+m:
+  %t = add i32 %lx, 1
+  ret i32 %t
+
+done:
+  ret i32 %s
+}
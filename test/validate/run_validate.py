@@ -0,0 +1,163 @@
+import argparse, glob, os, random, re, subprocess, sys, tempfile
+# Differential validation of the transform passes.
+#
+#   python3 run_validate.py --build <pass build dir> [--inputs 5] [--seed 1]
+#
+# Every module of the corpus (the phase2/phase3 examples, the benchmark
+# kernels, the per-pass cases in test/constprop and test/licm, the
+# regression cases in cases/ and IR from the perf generator) is run through
+# each variant: the CSElimination flag sets with -cse-verify,
+# ConstantPropagation and LoopInvariantCodeMotion. A function the verifier
+# rejects fails the run. Then every function taking only integer arguments
+# and returning an integer is called under lli with the same random
+# arguments in the original and in the transformed module, and the
+# printed results must agree. Calls that fail or do not finish within
+# --timeout in the original module are dropped, and so are modules that
+# have a main of their own.
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TEST = os.path.dirname(HERE)
+
+# (variant, pass, flags); the pass is loaded from <build>/<pass>/lib<pass>.so
+VARIANTS = [
+    ("cse", "CSElimination", []),
+    ("cse-copy-prop", "CSElimination", ["-cse-copy-prop"]),
+    ("cse-pre", "CSElimination", ["-cse-pre"]),
+    ("cse-copy-prop-pre", "CSElimination", ["-cse-copy-prop", "-cse-pre"]),
+    ("cse-pre-canonical", "CSElimination", ["-cse-pre", "-cse-canonical"]),
+    ("cse-pre-loads", "CSElimination", ["-cse-pre", "-cse-match-loads"]),
+    ("cse-copy-prop-pre-loads", "CSElimination", ["-cse-copy-prop", "-cse-pre", "-cse-match-loads"]),
+    ("cse-pre-compares", "CSElimination", ["-cse-pre", "-cse-match-loads", "-cse-compares"]),
+    ("cse-pre-addresses", "CSElimination", ["-cse-pre", "-cse-match-loads", "-cse-addresses"]),
+    ("cse-pre-calls", "CSElimination", ["-cse-pre", "-cse-match-loads", "-cse-pure-calls"]),
+    ("cse-pre-loads-canonical", "CSElimination", ["-cse-pre", "-cse-match-loads", "-cse-canonical"]),
+    ("cse-all", "CSElimination", ["-cse-copy-prop", "-cse-pre", "-cse-match-loads", "-cse-canonical",
+                                  "-cse-compares", "-cse-addresses", "-cse-pure-calls"]),
+    ("constprop", "ConstantPropagation", []),
+    ("licm", "LoopInvariantCodeMotion", []),
+]
+
+# flags a pass gets in every variant; opt verifies the module of the others
+VERIFY = {"CSElimination": ["-cse-verify"]}
+
+DEFINE = re.compile(r"^define [^@]*?\b(void|i\d+) @([\w.]+)\(([^)]*)\)", re.M)
+
+
+def corpus(workdir):
+    files = sorted(glob.glob(os.path.join(TEST, "phase*", "*.ll")) +
+                   glob.glob(os.path.join(TEST, "bench", "*.ll")) +
+                   glob.glob(os.path.join(TEST, "constprop", "*.ll")) +
+                   glob.glob(os.path.join(TEST, "licm", "*.ll")) +
+                   glob.glob(os.path.join(HERE, "cases", "*.ll")))
+    for v, b in [(10, 20), (20, 60)]:
+        path = os.path.join(workdir, "gen-%dx%d.ll" % (v, b))
+        with open(path, "w") as out:
+            subprocess.check_call([sys.executable, os.path.join(TEST, "perf", "gen_ir.py"), str(v), str(b)],
+                                  stdout=out)
+        files.append(path)
+    return files
+
+
+def callable_functions(ir):
+    """(name, return type, argument types) of functions lli can call with
+    random integers"""
+    functions = []
+    if re.search(r"^define [^@]*@main\(", ir, re.M):
+        return functions
+    for ret, name, params in DEFINE.findall(ir):
+        types = [p.split()[0] for p in params.split(",") if p.strip()]
+        if ret != "void" and all(re.match(r"^i\d+$", t) for t in types):
+            functions.append((name, ret, types))
+    return functions
+
+
+def with_main(ir, name, ret, types, args):
+    """ir plus a main that prints name(args)"""
+    lines = ["", "@.validate_format = private constant [6 x i8] c\"%lld\\0A\\00\""]
+    if not re.search(r"^declare .*@printf\(", ir, re.M):
+        lines.append("declare i32 @printf(i8*, ...)")
+    arguments = ", ".join("%s %d" % (t, a) for t, a in zip(types, args))
+    lines += ["define i32 @main() {",
+              "  %%r = call %s @%s(%s)" % (ret, name, arguments),
+              "  %%w = sext %s %%r to i64" % ret if ret != "i64" else "  %w = add i64 %r, 0",
+              "  %f = getelementptr [6 x i8], [6 x i8]* @.validate_format, i64 0, i64 0",
+              "  call i32 (i8*, ...) @printf(i8* %f, i64 %w)",
+              "  ret i32 0",
+              "}"]
+    return ir + "\n".join(lines) + "\n"
+
+
+def execute(args, ir, workdir):
+    """exit status and stdout of lli on ir, None on a timeout"""
+    path = os.path.join(workdir, "call.ll")
+    with open(path, "w") as f:
+        f.write(ir)
+    try:
+        result = subprocess.run([args.lli, path], stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                                universal_newlines=True, timeout=args.timeout)
+    except subprocess.TimeoutExpired:
+        return None
+    return "exit %d\n%s" % (result.returncode, result.stdout)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="differential validation of the transform passes")
+    parser.add_argument("--build", required=True, help="build directory of the passes")
+    parser.add_argument("--opt", default="opt")
+    parser.add_argument("--lli", default="lli")
+    parser.add_argument("--inputs", type=int, default=5, help="random argument tuples per function")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--timeout", type=float, default=5.0)
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    failures = 0
+    calls = 0
+    with tempfile.TemporaryDirectory() as workdir:
+        for path in corpus(workdir):
+            with open(path) as f:
+                original = f.read()
+            functions = callable_functions(original)
+            inputs = {name: [[rng.randrange(0, 1000) for _ in types] for _ in range(args.inputs)]
+                      for name, _, types in functions}
+            expected = {}
+
+            for variant, pass_name, flags in VARIANTS:
+                library = os.path.join(args.build, pass_name, "lib%s.so" % pass_name)
+                transformed = os.path.join(workdir, "transformed.ll")
+                result = subprocess.run([args.opt, "-enable-new-pm=0", "-load", library, "-" + pass_name] +
+                                        VERIFY.get(pass_name, []) + flags + [path, "-S", "-o", transformed],
+                                        stdout=subprocess.PIPE, stderr=subprocess.PIPE, universal_newlines=True)
+                case = "%s %s" % (os.path.relpath(path, TEST) if path.startswith(TEST) else
+                                  os.path.basename(path), variant)
+                if result.returncode != 0:
+                    failures += 1
+                    print("FAIL %s: verifier\n%s" % (case, result.stderr.strip().splitlines()[-1]))
+                    continue
+                with open(transformed) as f:
+                    ir = f.read()
+
+                failures_before = failures
+                for name, ret, types in functions:
+                    for call in inputs[name]:
+                        key = (name, tuple(call))
+                        if key not in expected:
+                            expected[key] = execute(args, with_main(original, name, ret, types, call), workdir)
+                        if expected[key] is None or not expected[key].startswith("exit 0\n"):
+                            continue
+                        calls += 1
+                        got = execute(args, with_main(ir, name, ret, types, call), workdir)
+                        if got != expected[key]:
+                            failures += 1
+                            print("FAIL %s: %s(%s) printed %r, expected %r" %
+                                  (case, name, ", ".join(map(str, call)), got, expected[key]))
+                if failures == failures_before:
+                    print("ok   %s" % case)
+                sys.stdout.flush()
+
+    print("%d calls compared, %d failures" % (calls, failures))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())